@@ -0,0 +1,128 @@
+#include "Checkpoint.h"
+
+#include <cstdio>
+#include <sstream>
+
+#include "../framework/Common.h"
+#include "../framework/BinaryIO.h"
+
+#define CHECKPOINT_MAGIC "SDDCKPT2"
+
+unsigned Checkpoint::load() {
+
+    wavefronts.clear();
+    records.clear();
+
+    std::ifstream fin(path, std::ios::binary);
+    if (!fin.is_open()) {
+        return 0;
+    }
+    std::ostringstream content;
+    content << fin.rdbuf();
+    std::string data = content.str();
+
+    const size_t header = sizeof(CHECKPOINT_MAGIC) - 1 + 8;
+    if (data.compare(0, sizeof(CHECKPOINT_MAGIC) - 1, CHECKPOINT_MAGIC) != 0) {
+        return 0;
+    }
+    BinaryReader key(data, sizeof(CHECKPOINT_MAGIC) - 1, data.size());
+    if (key.get64() != runKey || !key.isOk()) {
+        return 0;
+    }
+
+    // a record is its length, the hash of its content and the content
+    size_t pos = header;
+    while (data.size() - pos >= 12) {
+        BinaryReader record(data, pos, data.size());
+        uint32_t length = record.get32();
+        uint64_t hash = record.get64();
+        if (data.size() - pos - 12 < length) {
+            break;
+        }
+        size_t begin = pos + 12;
+        if (common::hashString(data.substr(begin, length)) != hash) {
+            break;
+        }
+
+        BinaryReader in(data, begin, begin + length);
+        std::vector<Entry> entries(in.get32());
+        for (Entry &entry : entries) {
+            entry.id = in.get32();
+            entry.key = in.get64();
+            entry.summary.read(in);
+        }
+        if (!in.isOk()) {
+            break;
+        }
+        wavefronts.push_back(entries);
+        pos = begin + length;
+    }
+    records = data.substr(header, pos - header);
+    return wavefronts.size();
+}
+
+/**
+ * the loaded records are written to a temporary file renamed over the checkpoint,
+ * so the checkpoint is complete whenever the run is killed, then records are appended to it.
+ */
+bool Checkpoint::open(unsigned interval) {
+
+    this->interval = interval;
+    lastFlush = std::chrono::steady_clock::now();
+
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream tmp(temporary, std::ios::binary | std::ios::trunc);
+        if (!tmp.is_open()) {
+            return false;
+        }
+        BinaryWriter head;
+        head.put64(runKey);
+        tmp << CHECKPOINT_MAGIC << head.data << records;
+        tmp.flush();
+        if (!tmp.good()) {
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+
+    fout.open(path, std::ios::binary | std::ios::app);
+    return fout.is_open();
+}
+
+void Checkpoint::write(const std::vector<Entry> &entries) {
+
+    if (!fout.is_open()) {
+        return;
+    }
+
+    BinaryWriter content;
+    content.put32(entries.size());
+    for (const Entry &entry : entries) {
+        content.put32(entry.id);
+        content.put64(entry.key);
+        entry.summary.write(content);
+    }
+    BinaryWriter record;
+    record.put32(content.data.size());
+    record.put64(common::hashString(content.data));
+    fout << record.data << content.data;
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (now - lastFlush >= std::chrono::seconds(interval)) {
+        fout.flush();
+        lastFlush = now;
+    }
+}
+
+void Checkpoint::remove() {
+
+    if (fout.is_open()) {
+        fout.close();
+    }
+    std::remove(path.c_str());
+}
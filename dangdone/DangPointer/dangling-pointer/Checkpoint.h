@@ -0,0 +1,85 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <chrono>
+
+#include <stdint.h>
+
+#include "FunctionSummary.h"
+
+/**
+ * checkpoint of a run, so a killed run can be resumed.
+ * A record with the summaries of the functions of a wavefront is appended when the wavefront is done.
+ * The warnings are part of the summaries, so replaying the records in order rebuilds the report.
+ * Each record has a length and a checksum, a record cut short by a kill is dropped.
+ */
+class Checkpoint {
+
+public:
+
+    /**
+     * a function of a completed wavefront, with the key of its summary.
+     */
+    class Entry {
+
+    public:
+
+        Entry() : id(0), key(0) {}
+        Entry(unsigned id, uint64_t key, const FunctionSummary &summary) : id(id), key(key), summary(summary) {}
+
+        unsigned id;
+        uint64_t key;
+        FunctionSummary summary;
+    };
+
+    /**
+     * runKey identifies the input and configuration of the run,
+     * a checkpoint of another run is not loaded.
+     */
+    Checkpoint(std::string path, uint64_t runKey) : path(path), runKey(runKey), interval(0) {}
+
+    /**
+     * read the completed wavefronts of the checkpoint file.
+     * return the number of wavefronts, 0 if the file is missing or of another run.
+     */
+    unsigned load();
+
+    /**
+     * start writing the checkpoint file, keeping the wavefronts read by load().
+     * Records are flushed to the file at most every interval seconds.
+     */
+    bool open(unsigned interval);
+
+    bool isOpen() const {
+        return fout.is_open();
+    }
+
+    void write(const std::vector<Entry> &entries);
+
+    /**
+     * delete the checkpoint file once the run is complete.
+     */
+    void remove();
+
+    const std::vector<std::vector<Entry>> &getWavefronts() const {
+        return wavefronts;
+    }
+
+private:
+
+    std::string path;
+    uint64_t runKey;
+
+    std::vector<std::vector<Entry>> wavefronts;
+    // the records read by load()
+    std::string records;
+
+    std::ofstream fout;
+    unsigned interval;
+    std::chrono::steady_clock::time_point lastFlush;
+};
+
+#endif
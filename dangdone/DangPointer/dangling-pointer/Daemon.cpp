@@ -0,0 +1,167 @@
+#include "Daemon.h"
+
+#include <sstream>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+namespace {
+
+/**
+ * the request of a connection, up to its first newline.
+ */
+bool readRequest(int fd, std::string &request) {
+
+    char buffer[4096];
+    while (request.find('\n') == std::string::npos) {
+        ssize_t size = read(fd, buffer, sizeof(buffer));
+        if (size < 0) {
+            return false;
+        }
+        if (size == 0) {
+            break;
+        }
+        request.append(buffer, size);
+    }
+    request = request.substr(0, request.find('\n'));
+    if (!request.empty() && request[request.size() - 1] == '\r') {
+        request.erase(request.size() - 1);
+    }
+    return true;
+}
+
+void writeReply(int fd, const std::string &reply) {
+
+    size_t written = 0;
+    while (written < reply.size()) {
+        // a client gone before the reply must not stop the daemon with SIGPIPE
+        ssize_t size = send(fd, reply.data() + written, reply.size() - written, MSG_NOSIGNAL);
+        if (size <= 0) {
+            return;
+        }
+        written += size;
+    }
+}
+
+} // end of anonymous namespace
+
+Daemon::Daemon(ASTManager &manager, ASTResource &resource, CallGraph &callGraph, CheckDriver &driver, DanglingPtr &checker, Config &configure) :
+    manager(manager), resource(resource), callGraph(callGraph), driver(driver), checker(checker), configure(configure) {
+
+    warnings = getWarnings();
+}
+
+std::set<std::string> Daemon::getWarnings() const {
+
+    std::set<std::string> lines;
+    for (const Warning &warning : checker.getWarnings()) {
+        lines.insert(warning.file + ":" + warning.line + ": " + warning.fun + ": " + warning.desc);
+    }
+    return lines;
+}
+
+bool Daemon::serve(std::string path) {
+
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    strcpy(address.sun_path, path.c_str());
+
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server == -1) {
+        return false;
+    }
+    // the socket of a daemon killed before its shutdown is left behind
+    unlink(path.c_str());
+    if (bind(server, (sockaddr *)&address, sizeof(address)) != 0 || listen(server, 16) != 0) {
+        close(server);
+        return false;
+    }
+    CHECKER_LOG(common::CheckerName::danglingPointer, 3, configure, "Daemon: listening on " + path + "\n");
+
+    bool stop = false;
+    while (!stop) {
+        int client = accept(server, nullptr, nullptr);
+        if (client == -1) {
+            // only a signal is retried, another error (e.g. EMFILE) would fail again at once
+            if (errno == EINTR) {
+                continue;
+            }
+            CHECKER_LOG(common::CheckerName::danglingPointer, 3, configure, std::string("Daemon: accept failed, ") + strerror(errno) + "\n");
+            close(server);
+            unlink(path.c_str());
+            return false;
+        }
+        std::string request;
+        if (readRequest(client, request)) {
+            writeReply(client, handle(request, stop));
+        }
+        close(client);
+    }
+    close(server);
+    unlink(path.c_str());
+    return true;
+}
+
+std::string Daemon::handle(const std::string &request, bool &stop) {
+
+    std::istringstream in(request);
+    std::string command;
+    in >> command;
+    if (command == "shutdown") {
+        stop = true;
+        return "end\n";
+    }
+    if (command != "check") {
+        return "error: unknown request " + command + "\n";
+    }
+    std::vector<std::string> ASTs;
+    std::string AST;
+    while (in >> AST) {
+        if (access(AST.c_str(), R_OK) != 0) {
+            return "error: cannot read " + AST + "\n";
+        }
+        ASTs.push_back(AST);
+    }
+    return recheck(ASTs);
+}
+
+std::string Daemon::recheck(const std::vector<std::string> &ASTs) {
+
+    TRACE_SPAN(span, "recheck", "daemon", "ASTs", std::to_string(ASTs.size()));
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (const std::string &AST : ASTs) {
+        manager.reloadAST(AST);
+    }
+    callGraph.update(manager, resource);
+    driver.run();
+
+    std::set<std::string> current = getWarnings();
+    std::string reply;
+    unsigned added = 0, removed = 0;
+    for (const std::string &warning : warnings) {
+        if (current.count(warning) == 0) {
+            reply += "- " + warning + "\n";
+            removed++;
+        }
+    }
+    for (const std::string &warning : current) {
+        if (warnings.count(warning) == 0) {
+            reply += "+ " + warning + "\n";
+            added++;
+        }
+    }
+    warnings.swap(current);
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    CHECKER_LOG(common::CheckerName::danglingPointer, 3, configure, "Daemon: " + std::to_string(ASTs.size()) + " ASTs checked again, "
+        + std::to_string(added) + " warnings added, " + std::to_string(removed) + " removed\n");
+    return reply + "end " + std::to_string(added) + " " + std::to_string(removed) + " " + std::to_string(seconds) + "\n";
+}
@@ -0,0 +1,53 @@
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include <string>
+#include <vector>
+#include <set>
+
+#include "DanglingPointer.h"
+
+/**
+ * serves rechecks of a program over a Unix socket, keeping its ASTs, call graph and summaries in memory.
+ * A request is one line, one request per connection:
+ *   check a.ast b.ast ...   the AST files changed or added since the last check
+ *   shutdown                stop the daemon
+ * The ASTs of a check are indexed again and the call graph is linked again, then the driver runs the checker:
+ * functions whose summary key is unchanged take their summary from memory, so only the changed
+ * functions and the callers whose callees' effects changed are analyzed.
+ * The reply to check is the diff of the warnings with the previous check, "+ " and "- " lines,
+ * and a last line "end added removed seconds". The reports in the output path are written again.
+ */
+class Daemon {
+
+public:
+
+    Daemon(ASTManager &manager, ASTResource &resource, CallGraph &callGraph, CheckDriver &driver, DanglingPtr &checker, Config &configure);
+
+    /**
+     * answer requests on the socket at path until shutdown, false if it cannot listen on it
+     * or stops accepting connections.
+     */
+    bool serve(std::string path);
+
+private:
+
+    ASTManager &manager;
+    ASTResource &resource;
+    CallGraph &callGraph;
+    CheckDriver &driver;
+    DanglingPtr &checker;
+    Config &configure;
+
+    // the warnings of the last check, as written in the diff
+    std::set<std::string> warnings;
+
+    std::set<std::string> getWarnings() const;
+    std::string handle(const std::string &request, bool &stop);
+    std::string recheck(const std::vector<std::string> &ASTs);
+
+    Daemon(const Daemon&);
+    Daemon& operator =(const Daemon&);
+};
+
+#endif
@@ -2,6 +2,7 @@
 #include "DanglingPointer.h"
 
 #define GLOBALVAR "_GLOBAL_"
+#define NOALIAS ~0u
 
 static llvm::cl::OptionCategory ToolingSampleCategory("Tooling Sample");
 
@@ -35,7 +36,8 @@ VarInfo::VarInfo(string varName, bool ifFree, bool ifStatic, string loc, string
     tmpLine = str.substr(pos2+1);
     this->line = stoi(tmpLine);
     ifNulled = false;
-    alias = NULL;
+    aliasSet = NOALIAS;
+    ifAlias = false;
     freeLike = NULL;
 	ifReported = false;
 }
@@ -107,6 +109,19 @@ FunInfo::FunInfo(string name, string varName, int ttl, string loc, int line)
 		this->line = line;
 }
 
+FunInfo::FunInfo(const TraceFrame &frame, int arg, string varName, int ttl)
+{
+    refCount = 0;
+    funName = frame.fun;
+    argsNum = arg;
+    var = varName;
+    TTL = ttl;
+    parent = NULL;
+    file = frame.file;
+    line = frame.line;
+    loc = file + ":" + to_string(line) + ":0";
+}
+
 /*
 class GlobalVarDecl : public ASTConsumer, public RecursiveASTVisitor<GlobalVarDecl> {
 
@@ -165,61 +180,26 @@ class GlobalVarDecl : public ASTConsumer, public RecursiveASTVisitor<GlobalVarDe
     list<VarInfo> variables;
 };
 */
-std::string DanglingPtr::replace_all(string str, const string old_value, const string new_value)
-{     
-    while(true){
-		string::size_type pos(0);     
-        if((pos=str.find(old_value))!=string::npos)     
-            str.replace(pos,old_value.length(),new_value);     
-        else 
-			break;     
-    }     
-    return str;
-} 
-
-int DanglingPtr::writingToXML(string fileName, string funName, string descr, string locLine)
+//one report per format of reportFormat, all with the warnings in the same order.
+int DanglingPtr::openReports()
 {
-    pugi::xml_node node = doc.append_child("error");
-
-    pugi::xml_node checker = node.append_child("checker");
-    checker.append_child(pugi::node_pcdata).set_value("MOLINT.POINTER.NULL.SET");
-
-	pugi::xml_node domain = node.append_child("domain");
-    domain.append_child(pugi::node_pcdata).set_value("STATIC_C");
-
-	pugi::xml_node file = node.append_child("file");
-	file.append_child(pugi::node_pcdata).set_value(replace_all(fileName, "\\", "/").c_str());
-
-	pugi::xml_node function = node.append_child("function");
-    function.append_child(pugi::node_pcdata).set_value(funName.c_str());
-
-	pugi::xml_node score = node.append_child("score");
-    score.append_child(pugi::node_pcdata).set_value("100");
-
-	pugi::xml_node ordered = node.append_child("ordered");
-    ordered.append_child(pugi::node_pcdata).set_value("false");
-
-	pugi::xml_node event = node.append_child("event");
-
-	pugi::xml_node main = event.append_child("main");
-    main.append_child(pugi::node_pcdata).set_value("true");
-
-	pugi::xml_node tag = event.append_child("tag");
-    tag.append_child(pugi::node_pcdata).set_value("Error");
-
-	pugi::xml_node description = event.append_child("description");
-    description.append_child(pugi::node_pcdata).set_value(descr.c_str());
-
-	pugi::xml_node line = event.append_child("line");
-    line.append_child(pugi::node_pcdata).set_value(locLine.c_str());
-
-
-	pugi::xml_node extra = node.append_child("extra");
-    extra.append_child(pugi::node_pcdata).set_value("none");
-
-	pugi::xml_node subcategory = node.append_child("subcategory");
-    subcategory.append_child(pugi::node_pcdata).set_value("none");
-
+	string path = configure->getOptionBlock("pathToReport")["path"] + "MOLINT.POINTER.NULL.SET";
+	reports.clear();
+	//the NoDang pass prefers the index to the XML report, an index of a previous run must not be left behind.
+	std::remove((path + ".idx").c_str());
+	for(const string &format : reportFormats)
+	{
+		if(format == "xml")
+			reports.push_back(std::unique_ptr<ReportWriter>(new XMLReportWriter(path + ".xml")));
+		else if(format == "sarif")
+			reports.push_back(std::unique_ptr<ReportWriter>(new SARIFReportWriter(path + ".sarif")));
+		else if(format == "jsonl")
+			reports.push_back(std::unique_ptr<ReportWriter>(new JSONLReportWriter(path + ".jsonl")));
+		else if(format == "index")
+			reports.push_back(std::unique_ptr<ReportWriter>(new IndexReportWriter(path + ".idx")));
+		else
+			CHECKER_LOG(common::CheckerName::danglingPointer, 3, *configure, "Config: unknown reportFormat " + format + "\n");
+	}
 	return 0;
 }
 
@@ -229,6 +209,7 @@ int DanglingPtr::reportWarning(VarInfo &tmp, VarInfo* alias)
 	string file = tmp.file, fun = tmp.fun;
     string desc;
 	string a;
+	string root;
     a = to_string(tmp.line);
 	tmp.ifReported = true;
 	if(alias == nullptr)
@@ -259,9 +240,7 @@ int DanglingPtr::reportWarning(VarInfo &tmp, VarInfo* alias)
 			file = trace->file;
 			
         }
-		if(reportedFun.find(trace) != reportedFun.end())
-			return 0;
-		reportedFun[trace] = true;
+		root = fun + ":" + file + ":" + a;
     }
 
 	/*if(tmp.freeLike != NULL && alias == nullptr) //This is not a accurate way to detect double free bugs.
@@ -278,149 +257,799 @@ int DanglingPtr::reportWarning(VarInfo &tmp, VarInfo* alias)
         }
     }*/
 	desc += ".";
+	Warning warning;
+	warning.file = file;
+	warning.fun = fun;
+	warning.desc = desc;
+	warning.line = a;
+	warning.root = root;
+	//the chain down to the release site, for the reports carrying a call trace
+	if(tmp.freeLike != NULL)
+		warning.trace = getTrace(tmp.freeLike);
+	//warnings are kept before deduplication, so a cached summary replays them exactly.
+	//they are emitted by the driver once the wavefront of the function is done.
+	if(curSummary != nullptr)
+		curSummary->addWarning(warning);
+	return 0;
+}
+
+int DanglingPtr::emitWarning(const Warning &warning)
+{
+	//only one warning is reported for the release site of a free-like chain.
+	if(warning.root != "")
+	{
+		if(reportedFun.find(warning.root) != reportedFun.end())
+			return 0;
+		reportedFun[warning.root] = true;
+	}
 	warningCount++;
-	writingToXML(file, fun, desc, a);
-	desc += " In function: " + fun;
-	common::printLog(desc + "\n", common::CheckerName::danglingPointer, 5, *configure);
+	Metrics::add(Metrics::WARNINGS);
+	if(ifResident)
+		emitted.push_back(warning);
+	for(std::unique_ptr<ReportWriter> &report : reports)
+		report->write(warning);
+	CHECKER_LOG(common::CheckerName::danglingPointer, 5, *configure, warning.desc + " In function: " + warning.fun + "\n");
     return 0;
 }
 
-void DanglingPtr::check(){
-    //analyze all global variables.
+static LangOptions getLangOptions()
+{
+	LangOptions LangOpts;
+	LangOpts.CPlusPlus = true;
+	return LangOpts;
+}
+
+DanglingPtr::DanglingPtr(ASTResource *resource, ASTManager *manager, CallGraph *call_graph, Config *configure):BasicChecker(resource, manager, call_graph, configure), LangOpts(getLangOptions()), Policy(LangOpts)
+{
+	ifResident = false;
+	summaryTable = nullptr;
+	cache = &summaryCache;
+	profile = nullptr;
+	pointsTo = nullptr;
+}
+
+//the worker shares the configuration, the summary table and the summary cache of checker.
+DanglingPtr::DanglingPtr(DanglingPtr *checker, ASTManager *manager):BasicChecker(checker->resource, manager, checker->call_graph, checker->configure), LangOpts(getLangOptions()), Policy(LangOpts)
+{
+	levelOfDete = checker->levelOfDete;
+	ifAdaptiveLevel = checker->ifAdaptiveLevel;
+	maxLevelOfDete = checker->maxLevelOfDete;
+	ifRegardParAsFreelike = checker->ifRegardParAsFreelike;
+	memoryReleaseFuns = checker->memoryReleaseFuns;
+	ifReleaseDelete = checker->ifReleaseDelete;
+	configHash = checker->configHash;
+	maxBlocks = checker->maxBlocks;
+	maxStatements = checker->maxStatements;
+	maxTime = checker->maxTime;
+	ifPointsTo = checker->ifPointsTo;
+	pointsTo = checker->pointsTo;
+	profile = checker->profile;
+	summaryTable = checker->summaryTable;
+	cache = checker->cache;
+	warningCount = 0;
+	curFunction = nullptr;
+	curSummary = nullptr;
+	ifResident = false;
+}
+
+BasicChecker *DanglingPtr::fork(ASTManager *manager)
+{
+	return new DanglingPtr(this, manager);
+}
+
+//returns the first wavefront to analyze, after the checkpoint of a resumed run.
+unsigned DanglingPtr::beginCheck(){
     warningCount = 0;
-    /*for (const auto &AST : r.getASTs()->getASTs()) {
-        //construct global variables
-        GlobalVarDecl globVar;
-        globVar.HandleTranslationUnit(*AST);
-        list<VarInfo>* tmp = globVar.getVars();
-        list<VarInfo>::iterator tmpIte;
-        for(tmpIte = tmp->begin(); tmpIte != tmp->end(); ++tmpIte)
-        {
-            VarInfo tmpVar = *tmpIte;
-            vis.push_front(tmpVar);
-        }
-    }*/
+    curFunction = nullptr;
+    curSummary = nullptr;
+    cache = &summaryCache;
     readConfig(*configure);
+	//a resident checker is run again, what the previous runs reported is forgotten.
+	reportedFun.clear();
+	degraded.clear();
+	emitted.clear();
+	if(ifResident && !summaryCache.isEnabled())
+		summaryCache.enable();
+	//with points-to a summary depends on the alias classes of the whole program, which its key does not cover,
+	//so summaries are neither read from nor written to the cache.
+	if(ifPointsTo)
+	{
+		cache = &noCache;
+		if(summaryCache.isEnabled())
+			CHECKER_LOG(common::CheckerName::danglingPointer, 3, *configure, "Summary cache: not used with pointsTo\n");
+	}
 
-	std::vector<ASTFunction *> nonTopoOrder = getNonTopoOrder();
-    for(auto astFunction:nonTopoOrder)
-    {
-        /*if(fNode == NULL)
-        {
-			
-            //remove free like functions, because the caller exceeds 
-            //CONFIG levels
-            list<FunInfo>::iterator iterator;
-            for(iterator = fis.begin(); iterator != fis.end(); ++iterator)
-            {
-                if(iterator->TTL == 0)
-                {
-                    reportWarning(*iterator);
-                }
-            }
-            fis.remove_if([](const FunInfo & value)->bool{
-                return value.TTL<=0;
-                });
-        }
-        else*/
-		if(astFunction != NULL)
-        {
-			FunctionDecl* fNode = manager->getFunctionDecl(astFunction);
-			std::unique_ptr<CFG>& cfg = manager->getCFG(astFunction);
-            std::string funName = fNode->getQualifiedNameAsString();
-			if( cfg == NULL)
+	//the points-to classes are computed once, before the ASTs are split between the workers.
+	program.reset();
+	pointsTo = nullptr;
+	if(ifPointsTo)
+	{
+		program.reset(new PointsTo(*manager, *resource, *call_graph));
+		pointsTo = program.get();
+		CHECKER_LOG(common::CheckerName::danglingPointer, 3, *configure, "Points-to: " + std::to_string(pointsTo->getLocations()) + " locations, " + std::to_string(pointsTo->getClasses()) + " classes\n");
+	}
+
+	table.reset(new SummaryTable(resource->getFunctions(false).size()));
+	summaryTable = table.get();
+	openReports();
+	functionCosts.reset();
+	profile = nullptr;
+	if(profileTop != 0)
+	{
+		functionCosts.reset(new Profile(profileTop));
+		profile = functionCosts.get();
+	}
+
+	//a resumed run starts after the wavefronts of the checkpoint.
+	checkpoint.reset(new Checkpoint(configure->getOptionBlock("pathToReport")["path"] + "dangling.checkpoint", checkpointInterval != 0 || ifResume ? getRunKey() : 0));
+	unsigned first = ifResume ? resumeFrom(*checkpoint) : 0;
+	if(checkpointInterval != 0 && !checkpoint->open(checkpointInterval))
+		CHECKER_LOG(common::CheckerName::danglingPointer, 3, *configure, "Checkpoint: cannot write the checkpoint file\n");
+	planSpill();
+	for(unsigned w = 0; w < first; w++)
+		spillSummaries(w);
+	return first;
+}
+
+//the SCCs of the wavefront are analyzed, their warnings are emitted in SCC order,
+//so the report does not depend on the number of threads.
+void DanglingPtr::endWavefront(unsigned wavefront)
+{
+	const std::vector<CallGraphSCC> &SCCs = call_graph->getSCCs();
+	const std::vector<unsigned> &SCCsOfWavefront = call_graph->getWavefronts()[wavefront];
+	{
+		TraceSpan reportSpan("writeReports", "report");
+		for(unsigned scc : SCCsOfWavefront)
+			for(ASTFunction *F : SCCs[scc].getFunctions())
+				for(const Warning &warning : summaryTable->get(F->getID())->getWarnings())
+					emitWarning(warning);
+	}
+
+	if(checkpoint->isOpen())
+	{
+		std::vector<Checkpoint::Entry> entries;
+		for(unsigned scc : SCCsOfWavefront)
+			for(ASTFunction *F : SCCs[scc].getFunctions())
+				entries.push_back(Checkpoint::Entry(F->getID(), summaryTable->getKey(F->getID()), *summaryTable->get(F->getID())));
+		checkpoint->write(entries);
+	}
+	spillSummaries(wavefront);
+}
+
+void DanglingPtr::endCheck(){
+	FunctionSummary summary;
+	for(ASTFunction *F : resource->getFunctions(false))
+	{
+		if(summaryTable->load(F->getID(), summary) && summary.getDegraded() != "")
+			degraded.push_back(F->getFullName() + ": " + summary.getDegraded());
+	}
+	std::sort(degraded.begin(), degraded.end());
+	deepenedChains = countDeepenedChains();
+
+	if(cache->isEnabled())
+	{
+		summaryCache.save();
+		CHECKER_LOG(common::CheckerName::danglingPointer, 5, *configure, "Summary cache: " + std::to_string(summaryCache.getHits()) + " hits, " + std::to_string(summaryCache.getMisses()) + " misses\n");
+		summaryCache.prune();
+	}
+	CHECKER_LOG(common::CheckerName::danglingPointer, 5, *configure, "TOTAL warning:" + std::to_string(warningCount) + "\n");
+	CHECKER_LOG(common::CheckerName::danglingPointer, 5, *configure, "Functions over budget: " + std::to_string(degraded.size()) + "\n");
+	if(ifAdaptiveLevel)
+		CHECKER_LOG(common::CheckerName::danglingPointer, 5, *configure, "Chains deepened: " + std::to_string(deepenedChains) + "\n");
+	{
+		TraceSpan reportSpan("closeReports", "report");
+		for(std::unique_ptr<ReportWriter> &report : reports)
+			report->close();
+	}
+	//the run is complete, it is not resumed again.
+	checkpoint->remove();
+	checkpoint.reset();
+	if(spillStore.isOpen())
+		CHECKER_LOG(common::CheckerName::danglingPointer, 3, *configure, "Spilled summaries: " + std::to_string(spillStore.getSize()) + " bytes\n");
+	spillStore.close();
+	if(profile != nullptr && !profile->write(configure->getOptionBlock("pathToReport")["path"] + "profile.json"))
+		CHECKER_LOG(common::CheckerName::danglingPointer, 3, *configure, "Profile: cannot write profile.json\n");
+	profile = nullptr;
+	functionCosts.reset();
+	pointsTo = nullptr;
+	program.reset();
+	summaryTable = nullptr;
+	table.reset();
+	cache = &summaryCache;
+}
+
+/**
+ * start the summary of a function, walked unless its summary is in the cache or it is over a budget.
+ * Its AST is only loaded and its CFG only built when it is not in the cache.
+ */
+bool DanglingPtr::beginFunction(ASTFunction *F, LazyFunction &function)
+{
+	//the key hashes the function's body, it is only computed for the cache.
+	uint64_t key = cache->isEnabled() ? getSummaryKey(F) : 0;
+	//an unchanged function is not analyzed again, its warnings are replayed.
+	if(cache->isEnabled() && cache->lookup(key, functionSummary))
+	{
+		Metrics::add(Metrics::CACHE_HITS);
+		summaryTable->set(F->getID(), functionSummary);
+		return false;
+	}
+
+	if(cache->isEnabled())
+		Metrics::add(Metrics::CACHE_MISSES);
+	summaryKey = key;
+	functionSummary = FunctionSummary();
+	curFunction = F;
+	curSummary = &functionSummary;
+
+	//the cost of the function for the profile, its CFG time includes the AST loaded for it.
+	cost = FunctionCost();
+	costReloads = manager->getReloads();
+	std::chrono::steady_clock::time_point start;
+	if(profile != nullptr)
+		start = std::chrono::steady_clock::now();
+	FunctionDecl* fNode = function.getDecl();
+	//a body over maxStatements is degraded before its CFG is built.
+	string reason = overBudget(fNode);
+	const CFG *cfg = reason == "" ? function.getCFG() : nullptr;
+	if(profile != nullptr)
+	{
+		cost.cfgTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if(cfg != NULL)
+		{
+			cost.blocks = cfg->getNumBlockIDs();
+			for(const CFGBlock *block : *cfg)
+				cost.statements += block->size();
+		}
+	}
+	if(cfg != NULL)
+		reason = overBudget(*cfg);
+	if(cfg == NULL || reason != "" || !fNode->hasBody())
+	{
+		finishFunction(F, fNode, reason);
+		return false;
+	}
+	std::string funName = fNode->getQualifiedNameAsString();
+	if(manager->getReleaseArg(fNode) != -1)
+	{
+		CHECKER_LOG(common::CheckerName::danglingPointer, 2, *configure, funName + " is memory release function, skipping.");
+		finishFunction(F, fNode, "");
+		return false;
+	}
+
+	CHECKER_LOG(common::CheckerName::danglingPointer, 2, *configure, "Function: " + funName+ " begin\n");
+	ifOverTime = false;
+	timeChecks = 0;
+	deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(maxTime);
+	Metrics::add(Metrics::FUNCTIONS_VISITED);
+	if(profile != nullptr)
+		visitStart = std::chrono::steady_clock::now();
+	clearLocalVar();
+	curDecl = fNode;
+	return true;
+}
+
+//store the summary of a function, a function over budget gets a summary built from its AST only.
+int DanglingPtr::finishFunction(ASTFunction *F, FunctionDecl *f, const string &reason)
+{
+	//the partial result of a function over budget is dropped.
+	if(reason != "")
+	{
+		CHECKER_LOG(common::CheckerName::danglingPointer, 3, *configure, "Function: " + f->getQualifiedNameAsString() + " over budget, " + reason + "\n");
+		functionSummary = FunctionSummary();
+		functionSummary.setDegraded(reason);
+		buildDegradedSummary(f);
+	}
+	if(profile != nullptr)
+	{
+		cost.name = F->getFullName();
+		cost.degraded = reason;
+		cost.reloads = manager->getReloads() - costReloads;
+		profile->add(cost);
+	}
+
+	curFunction = nullptr;
+	curSummary = nullptr;
+	summaryTable->set(F->getID(), functionSummary);
+	//a degraded summary depends on the budgets and on timing, so it is not cached.
+	if(reason == "" && cache->isEnabled())
+		cache->insert(summaryKey, functionSummary);
+	return 0;
+}
+
+/**
+ * key of the input and configuration of a run: the AST files in the order of astList, by their content.
+ * A checkpoint is only resumed by a run with the same key, so the functions and the wavefronts are the same.
+ */
+uint64_t DanglingPtr::getRunKey()
+{
+	uint64_t key = common::hashCombine(configHash, maxBlocks);
+	key = common::hashCombine(key, maxStatements);
+	key = common::hashCombine(key, maxTime);
+	std::vector<ASTFile*> files = resource->getASTFiles();
+	std::sort(files.begin(), files.end(), [](ASTFile *a, ASTFile *b) { return a->getID() < b->getID(); });
+	for(ASTFile *AF : files)
+		key = common::hashCombine(common::hashString(AF->getAST(), key), ASTCache::getContent(AF->getAST()));
+	return key;
+}
+
+//restore the summaries of the completed wavefronts and replay their warnings.
+unsigned DanglingPtr::resumeFrom(Checkpoint &checkpoint)
+{
+	unsigned wavefronts = checkpoint.load();
+	for(const std::vector<Checkpoint::Entry> &entries : checkpoint.getWavefronts())
+	{
+		for(const Checkpoint::Entry &entry : entries)
+		{
+			summaryTable->set(entry.id, entry.summary);
+			summaryTable->setKey(entry.id, entry.key);
+			//keep the summaries used before the kill in the summary cache
+			if(cache->isEnabled() && entry.summary.getDegraded() == "")
+				cache->insert(entry.key, entry.summary);
+			for(const Warning &warning : entry.summary.getWarnings())
+				emitWarning(warning);
+		}
+	}
+	CHECKER_LOG(common::CheckerName::danglingPointer, 3, *configure, "Checkpoint: resuming after " + std::to_string(wavefronts) + " wavefronts\n");
+	return wavefronts;
+}
+
+/**
+ * the summary of a function is read by the SCCs calling it, so it is cold once the
+ * highest wavefront of its callers, or its own, is done.
+ */
+int DanglingPtr::planSpill()
+{
+	const std::vector<CallGraphSCC> &SCCs = call_graph->getSCCs();
+	coldAfter.assign(call_graph->getWavefronts().size(), std::vector<unsigned>());
+	cold.clear();
+	resident = 0;
+	if(residentSummaries == 0)
+		return 0;
+	if(!spillStore.open(configure->getOptionBlock("pathToReport")["path"] + "dangling.spill"))
+	{
+		CHECKER_LOG(common::CheckerName::danglingPointer, 3, *configure, "Spill: cannot write the spill file\n");
+		return -1;
+	}
+
+	std::vector<unsigned> levelOf(resource->getFunctions(false).size(), 0);
+	for(const CallGraphSCC &scc : SCCs)
+		for(ASTFunction *F : scc.getFunctions())
+			levelOf[F->getID()] = scc.getLevel();
+	for(const CallGraphSCC &scc : SCCs)
+	{
+		for(ASTFunction *F : scc.getFunctions())
+		{
+			unsigned lastReader = scc.getLevel();
+			for(ASTFunction *parent : call_graph->getParents(F))
+				lastReader = std::max(lastReader, levelOf[parent->getID()]);
+			coldAfter[lastReader].push_back(F->getID());
+		}
+	}
+	return 0;
+}
+
+//spill cold summaries until at most residentSummaries are in memory.
+int DanglingPtr::spillSummaries(unsigned wavefront)
+{
+	if(!spillStore.isOpen())
+		return 0;
+	for(unsigned scc : call_graph->getWavefronts()[wavefront])
+		resident += call_graph->getSCCs()[scc].getFunctions().size();
+	cold.insert(cold.end(), coldAfter[wavefront].begin(), coldAfter[wavefront].end());
+	while(resident > residentSummaries && !cold.empty())
+	{
+		//a full disk stops the spilling, the summaries not written stay in memory.
+		if(!summaryTable->spill(cold.back(), spillStore))
+		{
+			CHECKER_LOG(common::CheckerName::danglingPointer, 3, *configure, "Spilled summaries: cannot write the spill file, summaries are kept in memory\n");
+			cold.clear();
+			residentSummaries = ~0u;
+			break;
+		}
+		cold.pop_back();
+		resident--;
+	}
+	return 0;
+}
+
+/**
+ * chains with a function above levelOfDete, by release site.
+ * Only chains of a global are deepened, they are the FREE_GLOBAL effects.
+ * They are counted from the summaries, so the count does not depend on the threads or a resume.
+ */
+unsigned DanglingPtr::countDeepenedChains()
+{
+	std::unordered_set<std::string> roots;
+	FunctionSummary summary;
+	for(ASTFunction *F : resource->getFunctions(false))
+	{
+		if(!summaryTable->load(F->getID(), summary))
+			continue;
+		for(const SummaryEffect &effect : summary.getEffects())
+		{
+			if(effect.kind != SummaryEffect::FREE_GLOBAL || effect.trace.size() <= (unsigned)levelOfDete)
 				continue;
-		    common::printLog("Function: " + funName+ " begin\n", common::CheckerName::danglingPointer, 2, *configure);
-            VisitFunDecl(fNode, levelOfDete, cfg);
-	        common::printLog("Function: " + funName + " end\n", common::CheckerName::danglingPointer, 2, *configure);
-        }
-    }
-    //deal with situation when a dangling pointer in F0, and F1 call F0. if detect level is 2, then F1 doesn't reach the last level of detecting. so we need to detect these situation at once.
-    //FIXME: to fix following bugs. the algorism is in oneNote-HW-TODO1
-    /*
-    list<FunInfo>::iterator iterator;
-    for(iterator = fis.begin(); iterator != fis.end(); iterator++)
-    {
-        FunInfo *tmp = iterator->parent;
-        while(tmp)
-        {
-            tmp->refCount++;
-            tmp = tmp->parent;
-        }
-    }
-    for(iterator = fis.begin(); iterator != fis.end(); iterator++)
-    {
-        if(iterator->refCount != 0)
-            continue;
-        int refCount = 0;
-        FunInfo *tmp = iterator->parent;
-        while(tmp)
-        {
-            tmp->refCount++;
-            refCount++;
-            tmp = tmp->parent;
-        }
-        if(refCount != levelOfDete)
-            reportWarning(*iterator);
-    }*/
-	finalCheck();
-	common::printLog("TOTAL warning:" + std::to_string(warningCount) + "\n", common::CheckerName::danglingPointer, 5, *configure);
-	if(warningCount != 0)
+			const TraceFrame &root = effect.trace.back();
+			roots.insert(root.fun + ":" + root.file + ":" + to_string(root.line));
+		}
+	}
+	return roots.size();
+}
+
+unsigned DanglingPtr::getDeepenedChains() const
+{
+	return deepenedChains;
+}
+
+const std::vector<std::string>& DanglingPtr::getDegraded() const
+{
+	return degraded;
+}
+
+void DanglingPtr::setResident()
+{
+	ifResident = true;
+}
+
+const std::vector<Warning>& DanglingPtr::getWarnings() const
+{
+	return emitted;
+}
+
+//counts the statements and expressions of a body, up to limit.
+class StatementCounter : public RecursiveASTVisitor<StatementCounter> {
+public:
+	StatementCounter(unsigned limit):count(0), limit(limit){}
+	bool VisitStmt(Stmt *S)
 	{
-		std::string xmlFile = configure->getOptionBlock("pathToReport")["path"] + "MOLINT.POINTER.NULL.SET.xml";
-		doc.save_file(xmlFile.c_str(), "\t", pugi::format_no_declaration);
+		return ++count <= limit;
 	}
+	unsigned count;
+private:
+	unsigned limit;
+};
+
+//maxStatements checked on the body, before the CFG is built.
+//A CFG has about one element per statement or expression of the body, so the body is a cheap bound of it.
+string DanglingPtr::overBudget(const FunctionDecl *f)
+{
+	if(maxStatements == 0 || f == nullptr || f->getBody() == nullptr)
+		return "";
+	StatementCounter counter(maxStatements);
+	counter.TraverseStmt(f->getBody());
+	if(counter.count > maxStatements)
+		return "statements over " + std::to_string(maxStatements) + " in the body";
+	return "";
 }
 
-int DanglingPtr::readConfig(Config &c){
-	//set level of detect and ifRegardParAsFreelike as fixed value.
-	//levelOfDete = 1;
-	//ifRegardParAsFreelike = true;
-	
-	std::unordered_map<std::string, std::string> ptrConfig = c.getOptionBlock("DanglingPointer");
-	std::unordered_map<std::string, std::string>::const_iterator got = ptrConfig.find("levelOfDete");
-	if(got == ptrConfig.end())
+//the budget a function's CFG is over, "" if it is within all of them.
+string DanglingPtr::overBudget(const CFG &cfg)
+{
+	unsigned blocks = cfg.getNumBlockIDs();
+	if(maxBlocks != 0 && blocks > maxBlocks)
+		return "blocks " + std::to_string(blocks) + " over " + std::to_string(maxBlocks);
+	if(maxStatements == 0)
+		return "";
+	unsigned statements = 0;
+	for(const CFGBlock *block : cfg)
+		statements += block->size();
+	if(statements > maxStatements)
+		return "statements " + std::to_string(statements) + " over " + std::to_string(maxStatements);
+	return "";
+}
+
+//whether the current function is over its time budget. The clock is read every 256 calls, or when forced.
+bool DanglingPtr::overTime(bool force)
+{
+	if(maxTime == 0 || ifOverTime)
+		return ifOverTime;
+	if(!force && (++timeChecks & 255) != 0)
+		return false;
+	ifOverTime = std::chrono::steady_clock::now() > deadline;
+	return ifOverTime;
+}
+
+//finds the parameters a function over budget releases or nullifies, by its AST only.
+class DegradedSummaryVisitor : public RecursiveASTVisitor<DegradedSummaryVisitor> {
+public:
+	DegradedSummaryVisitor(DanglingPtr *checker, FunctionDecl *f):checker(checker), f(f){}
+	bool VisitCallExpr(CallExpr *E)
 	{
-		common::printLog( "Config: levelOfDete not found, using default value:2\n", common::CheckerName::danglingPointer, 3, *configure);
-		levelOfDete = 2;
+		checker->addDegradedCall(f, E);
+		return true;
 	}
-	else
-		levelOfDete = stoi(got->second);
-	got = ptrConfig.find("ifRegardParAsFreelike");
-	if(got == ptrConfig.end())
+	bool VisitCXXDeleteExpr(CXXDeleteExpr *E)
 	{
-		common::printLog( "Config: ifRegardParAsFreelike not found, using default value:true\n", common::CheckerName::danglingPointer, 3, *configure);
-		ifRegardParAsFreelike = true;
+		if(checker->ifReleaseDelete)
+			checker->addDegradedRelease(f, E->getArgument(), E);
+		return true;
 	}
-	if(got->second == "true")
-		ifRegardParAsFreelike = true;
-	else
-		ifRegardParAsFreelike = false;
-	
-	std::unordered_map<std::string, std::string> memFuns = c.getOptionBlock("MemoryReleaseFunction");
-	std::unordered_map<std::string, std::string>::const_iterator memGot = memFuns.begin();
-	for(;memGot != memFuns.end(); memGot++)
+	bool VisitBinaryOperator(BinaryOperator *E)
 	{
-		int tmp = stoi(memGot->second);
-		memoryReleaseFuns[memGot->first] = tmp;
+		if(E->getOpcode() == BO_Assign)
+		{
+			checker->addNullifiedParam(f, E->getLHS(), E->getRHS());
+			checker->addDegradedNull(f, E->getLHS(), E->getRHS());
+		}
+		return true;
 	}
+private:
+	DanglingPtr *checker;
+	FunctionDecl *f;
+};
+
+/**
+ * the cheap summary of a function over budget, without paths or aliases:
+ * the parameters it releases, directly or through a callee, and the ones it nullifies.
+ * A global it releases, or a callee's chain of a global, is freed unless the function nulls the global
+ * anywhere, so callers do not get warnings the full analysis would drop. It reports nothing.
+ */
+int DanglingPtr::buildDegradedSummary(FunctionDecl *f)
+{
+	if(!f->hasBody() || manager->getReleaseArg(f) != -1)
+		return 0;
+	degradedGlobals.clear();
+	degradedNulls.clear();
+	DegradedSummaryVisitor visitor(this, f);
+	visitor.TraverseStmt(f->getBody());
+	for(const SummaryEffect &effect : degradedGlobals)
+	{
+		if(degradedNulls.count(effect.global) == 0)
+			curSummary->addEffect(effect);
+	}
+	return 0;
+}
+
+int DanglingPtr::addDegradedCall(FunctionDecl *f, const CallExpr *call)
+{
+	const FunctionDecl *callee = call->getDirectCallee();
+	if(callee == nullptr)
+		return 0;
+	int argNum = manager->getReleaseArg(callee);
+	if(argNum != -1)
+	{
+		if((unsigned)argNum < call->getNumArgs())
+			addDegradedRelease(f, call->getArg(argNum), call);
+		return 0;
+	}
+	ASTFunction *calleeFunction = call_graph->getFunction(const_cast<FunctionDecl*>(callee));
+	const FunctionSummary *summary = calleeFunction != nullptr ? summaryTable->get(calleeFunction->getID()) : nullptr;
+	if(summary == nullptr)
+		return 0;
+	//parameters passed on to a callee freeing or nullifying them
+	for(const SummaryEffect &effect : summary->getEffects())
+	{
+		//a chain of a global goes on to the callers if it has calls left, as in checkVar
+		if(effect.kind == SummaryEffect::FREE_GLOBAL)
+		{
+			if(effect.TTL <= 1)
+				continue;
+			string funName = f->getQualifiedNameAsString();
+			VarInfo callVar = VarInfo(effect.global, true, true, call->getLocStart().printToString(f->getASTContext().getSourceManager()), funName);
+			SummaryEffect chain(SummaryEffect::FREE_GLOBAL, -1, effect.global, effect.TTL - 1);
+			chain.trace.push_back(TraceFrame(funName, callVar.file, callVar.line));
+			chain.trace.insert(chain.trace.end(), effect.trace.begin(), effect.trace.end());
+			degradedGlobals.push_back(chain);
+			continue;
+		}
+		if(effect.param < 0 || (unsigned)effect.param >= call->getNumArgs())
+			continue;
+		if(effect.kind == SummaryEffect::FREE_PARAM)
+			addDegradedRelease(f, call->getArg(effect.param), call);
+		else if(const DeclRefExpr *DRE = dyn_cast<DeclRefExpr>(call->getArg(effect.param)->IgnoreParenImpCasts()))
+		{
+			const ParmVarDecl *PVD = dyn_cast<ParmVarDecl>(DRE->getDecl());
+			if(PVD != nullptr && PVD->getDeclContext() == f)
+				curSummary->addEffect(SummaryEffect(SummaryEffect::NULLIFY_PARAM, PVD->getFunctionScopeIndex(), "", 1));
+		}
+	}
+	return 0;
+}
+
+//same as the parameter and global cases of handleMemoryReleaseFun.
+int DanglingPtr::addDegradedRelease(FunctionDecl *f, const Expr *arg, const Stmt *release)
+{
+	const DeclRefExpr *DRE = dyn_cast<DeclRefExpr>(arg->IgnoreParenImpCasts());
+	if(DRE == nullptr)
+		return 0;
+	string funName = f->getQualifiedNameAsString();
+	string loc = release->getLocStart().printToString(f->getASTContext().getSourceManager());
+	const VarDecl *VD = dyn_cast<VarDecl>(DRE->getDecl());
+	if(VD != nullptr && !isa<ParmVarDecl>(VD) && !VD->isLocalVarDecl())
+	{
+		VarInfo globalVar = VarInfo(VD->getQualifiedNameAsString(), true, true, loc, funName);
+		SummaryEffect effect(SummaryEffect::FREE_GLOBAL, -1, globalVar.varName, levelOfDete);
+		effect.trace.push_back(TraceFrame(funName, globalVar.file, globalVar.line));
+		degradedGlobals.push_back(effect);
+		return 0;
+	}
+	if(!ifRegardParAsFreelike)
+		return 0;
+	const ParmVarDecl *PVD = dyn_cast<ParmVarDecl>(DRE->getDecl());
+	if(PVD == nullptr || PVD->getDeclContext() != f)
+		return 0;
+	VarInfo tmpVar = VarInfo(PVD->getQualifiedNameAsString(), true, false, loc, funName);
+	SummaryEffect effect(SummaryEffect::FREE_PARAM, PVD->getFunctionScopeIndex(), "", 1);
+	effect.trace.push_back(TraceFrame(funName, tmpVar.file, tmpVar.line));
+	curSummary->addEffect(effect);
+	return 0;
+}
+
+//a global assigned null anywhere in a function over budget is taken as nulled on every path.
+int DanglingPtr::addDegradedNull(const FunctionDecl *f, const Expr *lhs, const Expr *rhs)
+{
+	if(rhs->IgnoreParenCasts()->isNullPointerConstant(f->getASTContext(), Expr::NPC_ValueDependentIsNull) == Expr::NPCK_NotNull)
+		return 0;
+	const DeclRefExpr *DRE = dyn_cast<DeclRefExpr>(lhs->IgnoreParenImpCasts());
+	if(DRE == nullptr)
+		return 0;
+	const VarDecl *VD = dyn_cast<VarDecl>(DRE->getDecl());
+	if(VD != nullptr && !isa<ParmVarDecl>(VD) && !VD->isLocalVarDecl())
+		degradedNulls.insert(VD->getQualifiedNameAsString());
+	return 0;
+}
+
+/**
+ * key of a function's summary in the summary cache.
+ * It covers the function's source, the effects of its callees' summaries, whether it has callers
+ * (chains end at functions without callers) and the configuration.
+ * A callee analyzed again with the same effects leaves the key of its callers unchanged,
+ * so a change is only analyzed up to the callers it reaches.
+ */
+uint64_t DanglingPtr::getSummaryKey(ASTFunction *F)
+{
+	std::vector<uint64_t> calleeKeys;
+	for(ASTFunction *callee : call_graph->getChildren(F))
+	{
+		uint64_t calleeKey = summaryTable->getKey(callee->getID());
+		//callees in the same recursive cycle are not summarized yet.
+		if(calleeKey == 0)
+			calleeKeys.push_back(manager->getFunctionHash(callee));
+		else
+			calleeKeys.push_back(summaryTable->getInterface(callee->getID()));
+	}
+	std::sort(calleeKeys.begin(), calleeKeys.end());
+
+	uint64_t key = common::hashCombine(configHash, manager->getFunctionHash(F));
+	key = common::hashCombine(key, call_graph->getParents(F).empty() ? 0 : 1);
+	for(uint64_t calleeKey : calleeKeys)
+		key = common::hashCombine(key, calleeKey);
+	summaryTable->setKey(F->getID(), key);
+	return key;
+}
+
+int DanglingPtr::readConfig(Config &c){
+	//set level of detect and ifRegardParAsFreelike as fixed value.
+	//levelOfDete = 1;
+	//ifRegardParAsFreelike = true;
+	
+	//the blocks are compiled once by Config, so a check does not copy them.
+	const CheckOptions &options = c.getCheckOptions();
+	levelOfDete = options.levelOfDete;
+	if(options.defaultLevelOfDete)
+		CHECKER_LOG(common::CheckerName::danglingPointer, 3, *configure, "Config: levelOfDete not found, using default value:2\n");
+	//adaptive mode starts at levelOfDete and deepens the chains not resolved there.
+	ifAdaptiveLevel = options.adaptiveLevel;
+	maxLevelOfDete = levelOfDete;
+	if(ifAdaptiveLevel && options.maxLevelOfDete != 0)
+		maxLevelOfDete = std::max(levelOfDete, options.maxLevelOfDete);
+	deepenedChains = 0;
+	ifRegardParAsFreelike = options.regardParAsFreelike;
+	if(options.defaultRegardParAsFreelike)
+		CHECKER_LOG(common::CheckerName::danglingPointer, 3, *configure, "Config: ifRegardParAsFreelike not found, using default value:true\n");
+	
+	if(options.summaryCache != "" && !summaryCache.isEnabled())
+		summaryCache.load(options.summaryCache);
+
+	//budgets of a function, missing or 0 means no limit.
+	maxBlocks = options.maxBlocks;
+	maxStatements = options.maxStatements;
+	maxTime = options.maxTime;
+
+	reportFormats = options.reportFormats;
+	ifPointsTo = options.pointsTo;
+	residentSummaries = options.residentSummaries;
+	profileTop = options.profileTop;
+
+	//checkpointInterval = 0 means no checkpoint.
+	checkpointInterval = options.checkpointInterval;
+	ifResume = options.resume;
+	
+	memoryReleaseFuns.insert(options.releaseFunctions.begin(), options.releaseFunctions.end());
+	//functions are resolved to decls by the ASTManager, only delete is looked up by name
+	ifReleaseDelete = ifMemoryFun("delete") != -1;
+
+	//cached summaries are only valid for the same configuration.
+	configHash = common::hashCombine(common::hashString(""), levelOfDete);
+	configHash = common::hashCombine(configHash, ifRegardParAsFreelike);
+	configHash = common::hashCombine(configHash, maxLevelOfDete);
+	configHash = common::hashCombine(configHash, ifPointsTo);
+	for(auto &memFun : options.releaseFunctions)
+		configHash = common::hashCombine(common::hashString(memFun.first, configHash), memFun.second);
     return 0;
 }
 
+//global variables are cleared as well: what a function does to them reaches its callers through its summary.
 int DanglingPtr::clearLocalVar()
 {
-    list<VarInfo>::iterator iterator;
-    for(iterator = vis.begin(); iterator != vis.end(); ++iterator)
+    vis.clear();
+    fis.clear();
+    appliedEffects.clear();
+    freeEvents.clear();
+    assignments.clear();
+    curBlock = nullptr;
+    curIndex = 0;
+    aliasSets.clear();
+    aliasOwners.clear();
+    //ids of the function's variables are their positions in ASTFunction::getVariables()
+    varIDs.clear();
+    varCount = 0;
+    if(curFunction != nullptr)
     {
-        if(iterator->alias != NULL && !iterator->alias->ifStatic)
-            iterator->alias = NULL;
+        const std::vector<ASTVariable *> &variables = curFunction->getVariables();
+        for(unsigned i = 0; i < variables.size(); i++)
+            varIDs.insert(std::make_pair(variables[i]->getName(), i));
+        varCount = variables.size();
     }
-    vis.remove_if([](const VarInfo & value)->bool{
-        return !value.ifStatic;
-        });
     return 0;
 }
 
+//globals and member expressions like "s->p" get ids after the function's variables.
+unsigned DanglingPtr::getVarID(string varName)
+{
+	std::unordered_map<std::string, unsigned>::iterator got = varIDs.find(varName);
+	if(got != varIDs.end())
+		return got->second;
+	varIDs[varName] = varCount;
+	return varCount++;
+}
+
+int DanglingPtr::addFreeEvent(string varName, FreeEvent::Kind kind)
+{
+	if(curBlock == nullptr)
+		return 0;
+	freeEvents.push_back(FreeEvent(curBlock, curIndex, getVarID(varName), kind));
+	return 0;
+}
+
+/**
+ * decide which freed variables are nulled, by a dataflow analysis over the CFG:
+ * a free generates the variable, nulling or assigning it kills it.
+ * A variable is nulled if it is nulled somewhere and is not freed at the exit on any path.
+ */
+int DanglingPtr::resolveNulled(const CFG &myCFG)
+{
+	//events were added by two sweeps, put them back in the order of the blocks
+	std::stable_sort(freeEvents.begin(), freeEvents.end(), [](const FreeEvent &a, const FreeEvent &b) {
+		if(a.block->getBlockID() != b.block->getBlockID())
+			return a.block->getBlockID() < b.block->getBlockID();
+		return a.index < b.index;
+	});
+
+	BitVectorDataFlow dataFlow(myCFG, varCount);
+	llvm::BitVector nulled(varCount);
+	for(const FreeEvent &event : freeEvents)
+	{
+		if(event.kind == FreeEvent::FREE)
+			dataFlow.gen(event.block, event.var);
+		else
+			dataFlow.kill(event.block, event.var);
+		if(event.kind == FreeEvent::NULLIFY)
+			nulled.set(event.var);
+	}
+	dataFlow.solve();
+
+	const llvm::BitVector &freed = dataFlow.getIn(&myCFG.getExit());
+	for(VarInfo &var : vis)
+	{
+		std::unordered_map<std::string, unsigned>::iterator got = varIDs.find(var.varName);
+		if(got == varIDs.end())
+			continue;
+		var.ifNulled = nulled.test(got->second) && !freed.test(got->second);
+	}
+	return 0;
+}
+
 int DanglingPtr::ifMemoryFun(string funName)
 {
 	std::unordered_map<std::string, int>::iterator got = memoryReleaseFuns.find(funName);
@@ -442,8 +1071,8 @@ int DanglingPtr::getOperLine(string loc)
 
 int DanglingPtr::varStateTransform(string lfh, string rfh, FunctionDecl *f, string loc, string fun, Expr* rhs)
 {
-        list<VarInfo>::iterator iterator;
-        list<VarInfo>::iterator rfhIterator;
+        VarInfoList::iterator iterator;
+        VarInfoList::iterator rfhIterator;
 		const Expr* rhsV = rhs;
 		string rhsS = rfh;
         //cout<<lfh<<" = "<<rfh<<endl;
@@ -452,6 +1081,25 @@ int DanglingPtr::varStateTransform(string lfh, string rfh, FunctionDecl *f, stri
 		//excludes condition like "int a=0; a=a;"
 		if(lfh == rfh)
 			return 0;
+		//TODO: analyze whether RHS is null
+		while(const ImplicitCastExpr * it = dyn_cast<ImplicitCastExpr>(rhsV)){
+			rhsV=it->IgnoreImpCasts();
+		}
+		// NOTE: This is used to determine whether a freed pointer is nullified.
+		//else if(rhs->isNullPointerConstant(f->getASTContext(),Expr::NPC_NeverValueDependent) != Expr::NPCK_NotNull || rfh == "0")
+		bool ifNull = (rhsS.find("0") != -1 && rhsS.find("\'") == -1 && rhsS.find("\"") == -1) && rhs->isRValue() && !isa<CallExpr>(rhsV);
+		if(ifRfhStatic != -1)
+		{
+			//"p = q" makes p freed if q is freed in this function, wherever "free(q)" is.
+			addFreeEvent(lfh, rfhIterator->ifFree ? FreeEvent::FREE : FreeEvent::ASSIGN);
+		}
+		else if(ifNull)
+		{
+			//p may be tracked only later in the sweep, so the event is kept anyway.
+			if(ifStatic != -1)
+				CHECKER_LOG(common::CheckerName::danglingPointer, 2, *configure, lfh + " is nulled at " + loc + "\n");
+			addFreeEvent(lfh, FreeEvent::NULLIFY);
+		}
         if(ifStatic == -1)
         {
 			//The pattern is like "p = q" while free(q) but p isn't in vis.
@@ -461,18 +1109,12 @@ int DanglingPtr::varStateTransform(string lfh, string rfh, FunctionDecl *f, stri
 				tmp.ifNulled = rfhIterator->ifNulled;
 				vis.push_front(tmp);
 				iterator = vis.begin();
-				//alias is q points to p
-				iterator->alias = &(*rfhIterator);
-				rfhIterator->preAlias.push_back(&(*iterator));
+				//p joins the alias class of q
+				addAlias(*iterator, *rfhIterator);
 			}
             return 0;
         }
 
-		//TODO: analyze whether RHS is null
-		while(const ImplicitCastExpr * it = dyn_cast<ImplicitCastExpr>(rhsV)){
-			rhsV=it->IgnoreImpCasts();
-		}
-		
 		Expr::NullPointerConstantKind npk = rhsV->isNullPointerConstant(f->getASTContext(),Expr::NPC_ValueDependentIsNull);
         //cout<<"binary oper:"<<lfh<<rfh<<" "<<ifStatic<<endl;
 		/*int pos = rhsS.find_first_of(")");
@@ -483,61 +1125,38 @@ int DanglingPtr::varStateTransform(string lfh, string rfh, FunctionDecl *f, stri
         {
             //if it is alias
             //The pattern is like "p = q" while free(q) and p is in vis.
-			for(list<VarInfo*>::iterator aliasIte=iterator->preAlias.begin();aliasIte != iterator->preAlias.end();++ aliasIte)
-			{
-				(*aliasIte)->alias = NULL;
-			}
             VarInfo tmp = VarInfo(lfh, rfhIterator->ifFree, false, loc, fun);
             iterator->ifFree = rfhIterator->ifFree;
             iterator->ifNulled = rfhIterator->ifNulled;
             iterator->loc = tmp.loc;
             iterator->line = tmp.line;
             iterator->file = tmp.file;
-            iterator->alias = &(*rfhIterator);
-			rfhIterator->preAlias.push_back(&(*iterator));
-        }
-		// NOTE: This is used to determine whether a freed pointer is nullified.
-		//else if(rhs->isNullPointerConstant(f->getASTContext(),Expr::NPC_NeverValueDependent) != Expr::NPCK_NotNull || rfh == "0")
-		else if((rhsS.find("0") != -1 && rhsS.find("\'") == -1 && rhsS.find("\"") == -1) && rhs->isRValue() && !isa<CallExpr>(rhsV))
-        {
-            //if(rfh == "((void *)0)")    we assume if left oper contain freed var, then this var is nulled
-            //if it is nulled, iterator->line means the position of free fun.
-            if(getOperLine(loc) > iterator->line)
-            {
-			    common::printLog(lfh + " is nulled at " + loc + "\n", common::CheckerName::danglingPointer, 2, *configure);
-                iterator->ifNulled = true;
-            }
-            //to deal with this example: {free(gp); F0(gp);gp=null;} F0 is freelike
-            //FIXME: not distinguish global and local var
-            for(;iterator != vis.end(); ++ iterator)
-            {
-                if(iterator->varName == lfh)
-                {
-                    if(getOperLine(loc) > iterator->line)
-                        iterator->ifNulled = true;
-                }
-            }
+            //p leaves the class of its old value, the variables assigned from p stay there
+            addAlias(*iterator, *rfhIterator);
         }
+        //nulling is resolved by resolveNulled for all entries of lfh, e.g. {free(gp); F0(gp);gp=null;} F0 is freelike
         return 0;
 }
 
-int DanglingPtr::finalCheck(){
-	list<VarInfo>::iterator iterator;
-    for(iterator = vis.begin(); iterator != vis.end(); ++iterator)
+int DanglingPtr::checkVar(string funName)
+{
+    //printList();
+    VarInfoList::iterator iterator;
+	addProgramAliases();
+	//freed variables of each alias class, counted before the loop clears ifFree of the freed globals
+	llvm::BitVector freedElements(aliasSets.size());
+	std::vector<unsigned> freedMembers(aliasSets.size(), 0);
+	for(VarInfo &var : vis)
 	{
-		if(iterator->freeLike != NULL && iterator->ifReported == false)
+		if(var.aliasSet != NOALIAS && var.ifFree)
 		{
-			reportWarning(*iterator);
+			freedElements.set(var.aliasSet);
+			freedMembers[aliasSets.find(var.aliasSet)]++;
 		}
 	}
-    return 0;
-}
-
-int DanglingPtr::checkVar(string funName)
-{
-    //printList();
-    list<VarInfo>::iterator iterator;
-	VarInfo * ifAliasFreed = nullptr;
+	bool ifAliasFreed = false;
+	//a chain that is not nulled in a function without callers can not be nulled any more.
+	bool hasCallers = curFunction != nullptr && !call_graph->getParents(curFunction).empty();
     for(iterator = vis.begin(); iterator != vis.end(); ++iterator)
     {
 		if(iterator->fun == GLOBALVAR)
@@ -553,10 +1172,19 @@ int DanglingPtr::checkVar(string funName)
 				}
                 else
                 {
-                    //add global dangling var's info into FunInfo
+                    //add global dangling var's info into the summary
                     iterator->ifFree = false;
-                    fis.push_front(FunInfo(funName,iterator->varName, levelOfDete, iterator->loc, iterator->line));
+                    SummaryEffect effect(SummaryEffect::FREE_GLOBAL, -1, iterator->varName, levelOfDete);
+                    effect.trace.push_back(TraceFrame(funName, iterator->file, iterator->line));
+                    if(curSummary != nullptr)
+                        curSummary->addEffect(effect);
+                    fis.push_front(FunInfo(effect.trace.front(), -1, iterator->varName, levelOfDete));
                     iterator->freeLike = &(*fis.begin());
+                    if(!hasCallers)
+                    {
+                        iterator->fun = funName;
+                        reportWarning(*iterator);
+                    }
                 }
             }
         }
@@ -568,7 +1196,14 @@ int DanglingPtr::checkVar(string funName)
 			//it means this function called freelike function.
             if(!iterator->ifNulled)
             {
-                if(iterator->freeLike->TTL == 1)
+                //a chain run out here is deepened by one level if it can still be nulled by a caller.
+                //Chains nulled on the way stop at any level, so only the unresolved ones pay for the depth.
+                //Only chains of a global are deepened: a freed parameter has no name the callers could null.
+                int TTL = iterator->freeLike->TTL - 1;
+                if(TTL == 0 && ifAdaptiveLevel && hasCallers && !iterator->freeLike->var.empty()
+                    && getTrace(iterator->freeLike).size() < (unsigned)maxLevelOfDete)
+                    TTL = 1;
+                if(TTL == 0)
                 {
 					iterator->fun = funName;
 					reportWarning(*iterator);
@@ -576,39 +1211,36 @@ int DanglingPtr::checkVar(string funName)
                 else
                 {
 					iterator->fun = funName;
-                    FunInfo tmp = FunInfo(funName,  iterator->freeLike->var, iterator->freeLike->TTL - 1, iterator->loc, got->second);
-                    tmp.parent = iterator->freeLike;
-                    fis.push_front(tmp);
+                    //the chain goes on in the callers, through the summary of this function
+                    FunInfo tmp = FunInfo(funName,  iterator->freeLike->var, TTL, iterator->loc, got->second);
+                    SummaryEffect effect(SummaryEffect::FREE_GLOBAL, -1, tmp.var, tmp.TTL);
+                    effect.trace.push_back(TraceFrame(funName, tmp.file, tmp.line));
+                    std::vector<TraceFrame> calleeTrace = getTrace(iterator->freeLike);
+                    effect.trace.insert(effect.trace.end(), calleeTrace.begin(), calleeTrace.end());
+                    if(curSummary != nullptr)
+                        curSummary->addEffect(effect);
+                    if(!hasCallers)
+                        reportWarning(*iterator);
                 }
             }
         }
         //FIXME: there is a situation duplicated report a var: one time is local and the other is alias
-        if(iterator->alias != NULL)
+        if(iterator->ifAlias)
         {
-            VarInfo *tmp = iterator->alias;
-			set<VarInfo *> loopDetect;
-            while(tmp != NULL)
-            {
-				if(loopDetect.find(tmp) != loopDetect.end())
-					break;
-				loopDetect.insert(tmp);
-                if(tmp->ifFree)
-                    ifAliasFreed = tmp;
-				
-                tmp = tmp->alias;
-            }
-            loopDetect.clear();
-            if(ifAliasFreed != nullptr)
+            //another variable of the class is freed. Once one is, the later aliased variables are reported as well.
+            unsigned freed = freedMembers[aliasSets.find(iterator->aliasSet)];
+            if(freed > (freedElements.test(iterator->aliasSet) ? 1u : 0u))
+                ifAliasFreed = true;
+            if(ifAliasFreed)
             {
-                VarInfo *tmp = iterator->alias;
-                while(tmp != NULL)
+                for(unsigned member = aliasSets.next(iterator->aliasSet); member != iterator->aliasSet; member = aliasSets.next(member))
                 {
-                    if(!tmp->ifNulled)
+                    VarInfo *tmp = aliasOwners[member];
+                    if(tmp != nullptr && !tmp->ifNulled)
 					{
 						tmp->fun = funName;
                         reportWarning(*iterator, tmp);
 					}
-                    tmp = tmp->alias;
                 }
             }
         }
@@ -619,6 +1251,82 @@ int DanglingPtr::checkVar(string funName)
     return 0;
 }
 
+unsigned DanglingPtr::getAliasSet(VarInfo &var)
+{
+	if(var.aliasSet == NOALIAS)
+	{
+		var.aliasSet = aliasSets.add();
+		aliasOwners.push_back(&var);
+	}
+	return var.aliasSet;
+}
+
+/**
+ * "var = target": var gets a new element in the class of target.
+ * The old element of var stays in its class without a variable, so the
+ * variables assigned from the old value of var are still aliases of each other.
+ */
+int DanglingPtr::addAlias(VarInfo &var, VarInfo &target)
+{
+	if(var.aliasSet != NOALIAS)
+		aliasOwners[var.aliasSet] = nullptr;
+	var.aliasSet = NOALIAS;
+	aliasSets.unite(getAliasSet(var), getAliasSet(target));
+	var.ifAlias = true;
+	return 0;
+}
+
+/**
+ * key of a variable in the points-to analysis, 0 if it is not a variable or a field.
+ * Fields are named by the last member of the expression, e.g. "f" for "s->f".
+ */
+uint64_t DanglingPtr::getPointsToKey(const VarInfo &var)
+{
+	const string &name = var.varName;
+	if(name.empty() || !(isalpha(name[0]) || name[0] == '_' || name[0] == ':'))
+		return 0;
+	size_t member = name.find_last_of(".>");
+	if(member != string::npos)
+		return PointsTo::getFieldKey(name.substr(member + 1));
+	if(name.find_first_not_of("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_:") != string::npos)
+		return 0;
+	if(var.ifStatic)
+		return PointsTo::getGlobalKey(name);
+	for(unsigned i = 0; curDecl != nullptr && i < curDecl->getNumParams(); i++)
+	{
+		if(curDecl->getParamDecl(i)->getQualifiedNameAsString() == name)
+			return PointsTo::getParamKey(curFunction, i);
+	}
+	return PointsTo::getLocalKey(curFunction, name);
+}
+
+/**
+ * variables whose values may point to the same location join one alias class,
+ * however the alias was formed: through fields, parameters, returns or globals.
+ * As with "p = q", the variables after the first of a class are the aliases.
+ */
+int DanglingPtr::addProgramAliases()
+{
+	if(pointsTo == nullptr || curFunction == nullptr)
+		return 0;
+	std::unordered_map<unsigned, VarInfo*> firstOf;
+	for(VarInfo &var : vis)
+	{
+		unsigned valueClass = pointsTo->getValueClass(getPointsToKey(var));
+		if(valueClass == PointsTo::NONE)
+			continue;
+		std::unordered_map<unsigned, VarInfo*>::iterator got = firstOf.find(valueClass);
+		if(got == firstOf.end())
+		{
+			firstOf[valueClass] = &var;
+			continue;
+		}
+		aliasSets.unite(getAliasSet(var), getAliasSet(*got->second));
+		var.ifAlias = true;
+	}
+	return 0;
+}
+
 int DanglingPtr::addStaticVar(const Expr *expr)
 {
 	const Expr *exprTmp=expr;
@@ -629,7 +1337,7 @@ int DanglingPtr::addStaticVar(const Expr *expr)
 			const ValueDecl *valueDecl = declRef->getDecl();
 			if(const VarDecl* varDecl=dyn_cast<VarDecl>(valueDecl))
 			{
-				list<VarInfo>::iterator iterator;
+				VarInfoList::iterator iterator;
 				if(varDecl->isLocalVarDecl() )
 					return 0;
 				if(const ParmVarDecl* pv=dyn_cast<ParmVarDecl>(valueDecl))
@@ -652,9 +1360,9 @@ int DanglingPtr::addStaticVar(const Expr *expr)
 	return 0;
 }
 
-int DanglingPtr::ifStaticVar(string var, list<VarInfo>::iterator *iterator, string loc)
+int DanglingPtr::ifStaticVar(string var, VarInfoList::iterator *iterator, string loc)
 {
-    list<VarInfo>::iterator VarInfoIterator;
+    VarInfoList::iterator VarInfoIterator;
     for(VarInfoIterator = vis.begin(); VarInfoIterator != vis.end(); ++VarInfoIterator)
     {
         if(VarInfoIterator->varName == var)
@@ -670,7 +1378,7 @@ int DanglingPtr::ifStaticVar(string var, list<VarInfo>::iterator *iterator, stri
 }
 int DanglingPtr::handleMemoryReleaseFun(FunctionDecl *f, string varName, string loc)
 {
-    list<VarInfo>::iterator varIterator;
+    VarInfoList::iterator varIterator;
 	string funName = f->getQualifiedNameAsString();
     int ifStatic = ifStaticVar(varName, &varIterator, loc); 
     if(ifStatic == -1)
@@ -697,13 +1405,11 @@ int DanglingPtr::handleMemoryReleaseFun(FunctionDecl *f, string varName, string
             //if fun free it's parameter, we just verify whether the parameter is set as null.
             //regard it as a free like function but ttl is 1
             //FIXME: ttl set as 1 means it should be nulled in caller.
-            if(ifRegardParAsFreelike)
+            if(ifRegardParAsFreelike && curSummary != nullptr)
             {
-                std::unordered_map<std::string, int>::iterator got = ifCalled.find(funName);
-                if(got == ifCalled.end())
-                    fis.push_front(FunInfo(funName,i, 1, loc));
-                else
-                    fis.push_front(FunInfo(funName,i, 1, loc,got->second));
+                SummaryEffect effect(SummaryEffect::FREE_PARAM, i, "", 1);
+                effect.trace.push_back(TraceFrame(funName, varIterator->file, varIterator->line));
+                curSummary->addEffect(effect);
             }
         }
     }
@@ -715,177 +1421,290 @@ int DanglingPtr::handleMemoryReleaseFun(FunctionDecl *f, string varName, string
             varIterator->line = curPos;
     }
     varIterator->ifFree = true;
+    addFreeEvent(varName, FreeEvent::FREE);
 	return 0;
 }
 
-bool DanglingPtr::VisitFunDecl(FunctionDecl *f, int ttl, const std::unique_ptr<clang::CFG> &myCFG)
+/**
+ * apply the summary of the callee at a call site.
+ * freed parameters and globals become variables freed by a free-like function,
+ * nullified parameters null the variables whose address is passed.
+ */
+int DanglingPtr::applySummary(FunctionDecl *f, const CallExpr *call, string loc, const PrintingPolicy &Policy)
 {
-    if (f->hasBody()) {
-        string funName = f->getQualifiedNameAsString();
-		std::unordered_map<std::string, int>::iterator got = memoryReleaseFuns.find(funName);
-		if(got != memoryReleaseFuns.end())
+	FunctionDecl *callee = const_cast<FunctionDecl*>(call->getDirectCallee());
+	if(callee == nullptr)
+		return 0;
+	ASTFunction *calleeFunction = call_graph->getFunction(callee);
+	if(calleeFunction == nullptr)
+		return 0;
+	const FunctionSummary *summary = summaryTable->get(calleeFunction->getID());
+	if(summary == nullptr)
+		return 0;
+
+	string funName = f->getQualifiedNameAsString();
+	ifCalled[callee->getQualifiedNameAsString()] = getOperLine(loc);
+	for(const SummaryEffect &effect : summary->getEffects())
+	{
+		if(effect.kind == SummaryEffect::FREE_GLOBAL)
 		{
-			common::printLog(funName + " is memory release function, skipping.", common::CheckerName::danglingPointer, 2, *configure);
-			return false;
+			//global variable is freed
+			//two or more global var's free is not handlled, as I don't know whether this var is the first time handlled or not.
+			FunInfo *freeLike = applyEffect(effect);
+			VarInfoList::iterator varIterator;
+			int ifStatic = ifStaticVar(effect.global, &varIterator, loc); 
+			if(ifStatic == -1 || varIterator->freeLike != freeLike)
+			{
+				VarInfo tmpVar = VarInfo(effect.global, true,  true, loc, funName);
+				tmpVar.freeLike = freeLike;
+				vis.push_front(tmpVar);
+			}
+			addFreeEvent(effect.global, FreeEvent::FREE);
+			continue;
 		}
-        for(unsigned int i = 0; i<f->getNumParams();i++)
-        {
-            string arg =  f->parameters()[i]->getQualifiedNameAsString();;
-        }
-        clearLocalVar();
-        Stmt *FuncBody = f->getBody();
-        int i = 0;
-        LangOptions LangOpts;
-        LangOpts.CPlusPlus = true;
-        PrintingPolicy Policy(LangOpts);
-        LangOptions LO;
-        LO.CPlusPlus=1; 
-        //myCFG->dump(LO,true);
-
-        for(CFG::iterator iter=myCFG->begin();iter!=myCFG->end();++iter)
-        {
-            CFGBlock* block=*iter;
-            for(CFGBlock::iterator iterblock=block->begin();iterblock!=block->end();++iterblock)
-            {
-                CFGElement element=(*iterblock);
-                if(element.getKind()!=CFGElement::Kind::Statement)
-                    continue;
-                const Stmt* it=((CFGStmt*)&element)->getStmt();
-				//it->dump();
-				//cout<<it->getStmtClass()<<endl;
-                if(it->getStmtClass() == Stmt::CallExprClass)
-                {
-                    const CallExpr *tmp = cast<CallExpr>(it);
-                    string TypeS;
-                    llvm::raw_string_ostream s(TypeS);
-                    tmp->getCallee()->printPretty(s, 0, Policy);
-                    //if it's a memory free call
-                    int argNum = ifMemoryFun(s.str());
-                    if(argNum != -1)
-                    {
-                        string argS;
-                        llvm::raw_string_ostream args(argS);
-                        const Expr * freeArg = tmp->getArg(argNum);
-						freeArg->printPretty(args, 0, Policy);
-						//add static variables before these variables used
-						addStaticVar(freeArg);
-
-                        list<VarInfo>::iterator varIterator;
-                        SourceManager *sm;
-                        sm = &(f->getASTContext().getSourceManager()); 
-                        string loc = tmp->getLocStart().printToString(*sm);
-						handleMemoryReleaseFun(f, args.str(), loc);
-                    }
-                    else
-                    {
-                        //if the callee is free like function.
-                        SourceManager *sm;
-                        sm = &(f->getASTContext().getSourceManager()); 
-                        string loc = tmp->getLocStart().printToString(*sm);
-                        list<FunInfo>::iterator iterator;
-                        //printList();
-                        for(iterator = fis.begin(); iterator != fis.end(); ++iterator)
-                        {
-                            if(s.str() == iterator->funName)
-                            {
-                                ifCalled[iterator->funName] = getOperLine(loc);
-                                if(iterator->argsNum!= -1)
-                                {
-                                    //callee's parameters is freed
-                                    string argName;
-                                    llvm::raw_string_ostream args(argName);
-                                    const Expr * freeArg = tmp->getArg(iterator->argsNum);
-									freeArg->printPretty(args, 0, Policy);
-									addStaticVar(freeArg);
-
-                                    VarInfo tmpVar = VarInfo(args.str(), true,  false, loc, funName);
-                                    tmpVar.freeLike = &(*iterator);
-                                    vis.push_front(tmpVar);
-                                }
-                                else
-                                {
-                                    //global variable is freed
-                                    //two or more global var's free is not handlled, as I don't know whether this var is the first time handlled or not.
-                                    list<VarInfo>::iterator varIterator;
-                                    int ifStatic = ifStaticVar(iterator->var, &varIterator, loc); 
-                                    if(ifStatic == -1 || (ifStatic != -1 && varIterator->freeLike != &(*iterator)))
-                                    {
-                                        VarInfo tmpVar = VarInfo(iterator->var, true,  true, loc, funName);
-                                        tmpVar.freeLike = &(*iterator);
-                                        vis.push_front(tmpVar);
-                                    }
-                                }
-                            } 
-                        }
-                    }
-                }
-				else if(it->getStmtClass() == Stmt::CXXDeleteExprClass)
+		if(effect.param < 0 || (unsigned)effect.param >= call->getNumArgs())
+			continue;
+		const Expr *arg = call->getArg(effect.param);
+		if(effect.kind == SummaryEffect::FREE_PARAM)
+		{
+			//callee's parameters is freed
+			string argName;
+			llvm::raw_string_ostream args(argName);
+			arg->printPretty(args, 0, Policy);
+			addStaticVar(arg);
+
+			VarInfo tmpVar = VarInfo(args.str(), true,  false, loc, funName);
+			tmpVar.freeLike = applyEffect(effect);
+			vis.push_front(tmpVar);
+			addFreeEvent(args.str(), FreeEvent::FREE);
+		}
+		else
+		{
+			//callee nullifies the pointer whose address is passed, e.g. F(&p) with F(T **pp){*pp = NULL;}
+			const Expr *argV = arg->IgnoreParenImpCasts();
+			if(const UnaryOperator *UO = dyn_cast<UnaryOperator>(argV))
+			{
+				if(UO->getOpcode() == UO_AddrOf)
 				{
-					if(ifMemoryFun("delete") == -1)
-						continue;
-					//handle delete p
-					const CXXDeleteExpr *tmp = cast<CXXDeleteExpr>(it);
-                    string argS;
-                    llvm::raw_string_ostream args(argS);
-                    const Expr * freeArg = tmp->getArgument();
-					freeArg->printPretty(args, 0, Policy);
-					addStaticVar(freeArg);
-
-                    list<VarInfo>::iterator varIterator;
-                    SourceManager *sm;
-                    sm = &(f->getASTContext().getSourceManager()); 
-                    string loc = tmp->getLocStart().printToString(*sm);
-					handleMemoryReleaseFun(f, args.str(), loc);
+					string argName;
+					llvm::raw_string_ostream args(argName);
+					UO->getSubExpr()->printPretty(args, 0, Policy);
+					markNulled(args.str(), loc);
 				}
+			}
+			//the parameter is passed on, so this function nullifies it as well.
+			else if(const DeclRefExpr *DRE = dyn_cast<DeclRefExpr>(argV))
+			{
+				if(const ParmVarDecl *PVD = dyn_cast<ParmVarDecl>(DRE->getDecl()))
+				{
+					if(curSummary != nullptr && PVD->getDeclContext() == f)
+						curSummary->addEffect(SummaryEffect(SummaryEffect::NULLIFY_PARAM, PVD->getFunctionScopeIndex(), "", 1));
+				}
+			}
+		}
+	}
+	return 0;
+}
+
+/**
+ * build the FunInfo chain of a callee effect, the first FunInfo is the callee.
+ * The chain is built once per function, so a global freed by two calls is reported once.
+ */
+FunInfo* DanglingPtr::applyEffect(const SummaryEffect &effect)
+{
+	std::unordered_map<const SummaryEffect*, FunInfo*>::iterator got = appliedEffects.find(&effect);
+	if(got != appliedEffects.end())
+		return got->second;
+
+	FunInfo *parent = NULL;
+	for(auto frame = effect.trace.rbegin(); frame != effect.trace.rend(); ++frame)
+	{
+		fis.push_front(FunInfo(*frame, effect.param, effect.global, effect.TTL));
+		fis.begin()->parent = parent;
+		parent = &(*fis.begin());
+	}
+	appliedEffects[&effect] = parent;
+	return parent;
+}
+
+std::vector<TraceFrame> DanglingPtr::getTrace(FunInfo *freeLike)
+{
+	std::vector<TraceFrame> trace;
+	for(; freeLike != NULL; freeLike = freeLike->parent)
+		trace.push_back(TraceFrame(freeLike->funName, freeLike->file, freeLike->line));
+	return trace;
+}
+
+//same as nulling in varStateTransform.
+int DanglingPtr::markNulled(string varName, string loc)
+{
+	CHECKER_LOG(common::CheckerName::danglingPointer, 2, *configure, varName + " is nulled at " + loc + "\n");
+	return addFreeEvent(varName, FreeEvent::NULLIFY);
+}
+
+/**
+ * record "nullifies parameter i" in the summary for *p = NULL,
+ * or p = NULL when p is a reference, p being the parameter i.
+ */
+int DanglingPtr::addNullifiedParam(FunctionDecl *f, const Expr *lhs, const Expr *rhs)
+{
+	if(curSummary == nullptr)
+		return 0;
+	if(rhs->IgnoreParenCasts()->isNullPointerConstant(f->getASTContext(), Expr::NPC_ValueDependentIsNull) == Expr::NPCK_NotNull)
+		return 0;
+
+	const Expr *lhsV = lhs->IgnoreParenImpCasts();
+	bool deref = false;
+	if(const UnaryOperator *UO = dyn_cast<UnaryOperator>(lhsV))
+	{
+		if(UO->getOpcode() != UO_Deref)
+			return 0;
+		lhsV = UO->getSubExpr()->IgnoreParenImpCasts();
+		deref = true;
+	}
+	const DeclRefExpr *DRE = dyn_cast<DeclRefExpr>(lhsV);
+	if(DRE == nullptr)
+		return 0;
+	const ParmVarDecl *PVD = dyn_cast<ParmVarDecl>(DRE->getDecl());
+	if(PVD == nullptr || PVD->getDeclContext() != f)
+		return 0;
+	if(deref || PVD->getType()->isReferenceType())
+		curSummary->addEffect(SummaryEffect(SummaryEffect::NULLIFY_PARAM, PVD->getFunctionScopeIndex(), "", 1));
+	return 0;
+}
+
+//the statements the checker handles in the single CFG walk of a function
+void DanglingPtr::subscribe(CFGVisitor &visitor)
+{
+	visitor.subscribe<CallExpr, DanglingPtr, &DanglingPtr::VisitCallExpr>(this);
+	visitor.subscribe<CXXDeleteExpr, DanglingPtr, &DanglingPtr::VisitCXXDeleteExpr>(this);
+	visitor.subscribe<BinaryOperator, DanglingPtr, &DanglingPtr::VisitBinaryOperator>(this);
+}
+
+void DanglingPtr::VisitCallExpr(const CallExpr *tmp, const CFGBlock *block, unsigned index)
+{
+    if(overTime())
+        return;
+    FunctionDecl *f = curDecl;
+    curBlock = block;
+    curIndex = index;
+    //if it's a memory free call, the callee is compared by decl so "(free)(p)" or a macro around free match as well
+    const FunctionDecl *callee = tmp->getDirectCallee();
+    int argNum = callee != nullptr ? manager->getReleaseArg(callee) : -1;
+    if(argNum != -1 && (unsigned)argNum < tmp->getNumArgs())
+    {
+        string argS;
+        llvm::raw_string_ostream args(argS);
+        const Expr * freeArg = tmp->getArg(argNum);
+		freeArg->printPretty(args, 0, Policy);
+		//add static variables before these variables used
+		addStaticVar(freeArg);
+
+        SourceManager *sm;
+        sm = &(f->getASTContext().getSourceManager()); 
+        string loc = tmp->getLocStart().printToString(*sm);
+		handleMemoryReleaseFun(f, args.str(), loc);
+    }
+    else
+    {
+        //if the callee is free like function.
+        SourceManager *sm;
+        sm = &(f->getASTContext().getSourceManager()); 
+        string loc = tmp->getLocStart().printToString(*sm);
+        applySummary(f, tmp, loc, Policy);
+    }
+}
+
+void DanglingPtr::VisitCXXDeleteExpr(const CXXDeleteExpr *tmp, const CFGBlock *block, unsigned index)
+{
+	if(!ifReleaseDelete || overTime())
+		return;
+    FunctionDecl *f = curDecl;
+    curBlock = block;
+    curIndex = index;
+	//handle delete p
+    string argS;
+    llvm::raw_string_ostream args(argS);
+    const Expr * freeArg = tmp->getArgument();
+	freeArg->printPretty(args, 0, Policy);
+	addStaticVar(freeArg);
+
+    SourceManager *sm;
+    sm = &(f->getASTContext().getSourceManager()); 
+    string loc = tmp->getLocStart().printToString(*sm);
+	handleMemoryReleaseFun(f, args.str(), loc);
+}
+
+//assignments are handled in endFunction, once all frees of the function are known.
+void DanglingPtr::VisitBinaryOperator(const BinaryOperator *E, const CFGBlock *block, unsigned index)
+{
+	if(E->getOpcode() != BO_Assign || overTime())
+		return;
+	assignments.push_back(PendingAssign(E, block, index));
+}
+
+void DanglingPtr::endFunction(ASTFunction *F, FunctionDecl *f, const CFG &cfg)
+{
+	resolveFunction(f, cfg);
+	if(profile != nullptr)
+	{
+		cost.visitTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - visitStart).count();
+		cost.varInfos = vis.size();
+		cost.funInfos = fis.size();
+	}
+	Metrics::max(Metrics::VARINFO_MAX, vis.size());
+	Metrics::max(Metrics::FUNINFO_MAX, fis.size());
+	string reason = ifOverTime ? "time over " + std::to_string(maxTime) + "ms" : "";
+	CHECKER_LOG(common::CheckerName::danglingPointer, 2, *configure, "Function: " + f->getQualifiedNameAsString() + " end\n");
+	finishFunction(F, f, reason);
+}
+
+//the assignments, nullings and checks of a walked function, stopped when it is over time.
+int DanglingPtr::resolveFunction(FunctionDecl *f, const CFG &cfg)
+{
+    string funName = f->getQualifiedNameAsString();
+    for(const PendingAssign &assign : assignments)
+    {
+        if(overTime())
+            return 0;
+        const BinaryOperator *E = assign.expr;
+        curBlock = assign.block;
+        curIndex = assign.index;
+        Expr* lhs = E->getLHS();  
+        Expr* rhs = E->getRHS();
+		addStaticVar(lhs);
+		addStaticVar(rhs);
+		addNullifiedParam(f, lhs, rhs);
+		if (MemberExpr *MRE = dyn_cast<MemberExpr>(lhs))
+		{
+			string slhs, srhs;
+			llvm::raw_string_ostream s1(slhs);
+			MRE->printPretty(s1, 0, Policy);
+			llvm::raw_string_ostream s2(srhs);
+			rhs->printPretty(s2, 0, Policy);
+			SourceManager *sm;
+			sm = &(f->getASTContext().getSourceManager()); 
+			string loc = E->getLocStart().printToString(*sm);
+            varStateTransform(s1.str(),s2.str(),f, loc, funName, rhs);
+		}
+        if (DeclRefExpr *DRE = dyn_cast<DeclRefExpr>(lhs)) {
+            if (VarDecl *VD = dyn_cast<VarDecl>(DRE->getDecl())) {
+                string TypeS;
+                llvm::raw_string_ostream s(TypeS);
+                rhs->printPretty(s, 0, Policy);
+                SourceManager *sm;
+                sm = &(f->getASTContext().getSourceManager()); 
+                string loc = E->getLocStart().printToString(*sm);
+                varStateTransform(VD->getQualifiedNameAsString(),s.str(),f, loc, funName, rhs);
             }
         }
-        for(CFG::iterator iter=myCFG->begin();iter!=myCFG->end();++iter)
-        {
-            CFGBlock* block=*iter;
-            for(CFGBlock::iterator iterblock=block->begin();iterblock!=block->end();++iterblock)
-            {
-                CFGElement element=(*iterblock);
-                if(element.getKind()!=CFGElement::Kind::Statement)
-                    continue;
-                const Stmt* it=((CFGStmt*)&element)->getStmt();
-                if(it->getStmtClass() == Stmt::BinaryOperatorClass)
-                {
-                    const BinaryOperator *E = cast<BinaryOperator>(it);
-					if(E->getOpcode() != BO_Assign)
-						continue;
-                    Expr* lhs = E->getLHS();  
-                    Expr* rhs = E->getRHS();
-					addStaticVar(lhs);
-					addStaticVar(rhs);
-					if (MemberExpr *MRE = dyn_cast<MemberExpr>(lhs))
-					{
-						string slhs, srhs;
-						llvm::raw_string_ostream s1(slhs);
-						MRE->printPretty(s1, 0, Policy);
-						llvm::raw_string_ostream s2(srhs);
-						rhs->printPretty(s2, 0, Policy);
-						SourceManager *sm;
-						sm = &(f->getASTContext().getSourceManager()); 
-						string loc = E->getLocStart().printToString(*sm);
-                        varStateTransform(s1.str(),s2.str(),f, loc, funName, rhs);
-					}
-                    if (DeclRefExpr *DRE = dyn_cast<DeclRefExpr>(lhs)) {
-                        if (VarDecl *VD = dyn_cast<VarDecl>(DRE->getDecl())) {
-                            string TypeS;
-                            llvm::raw_string_ostream s(TypeS);
-                            rhs->printPretty(s, 0, Policy);
-                            SourceManager *sm;
-                            sm = &(f->getASTContext().getSourceManager()); 
-                            string loc = E->getLocStart().printToString(*sm);
-                            varStateTransform(VD->getQualifiedNameAsString(),s.str(),f, loc, funName, rhs);
-                        }
-                    }
-                }
-            }
-        }
-    checkVar(funName);
     }
-    return true;
+    curBlock = nullptr;
+    if(overTime(true))
+        return 0;
+    resolveNulled(cfg);
+    checkVar(funName);
+    return 0;
 }
 
 void DanglingPtr::printList()
@@ -894,71 +1713,31 @@ void DanglingPtr::printList()
     bool ifFun = true;
     if(ifVar)
     {
-		common::printLog("-------------VarInfo--------", common::CheckerName::danglingPointer, 1, *configure);
-        list<VarInfo>::iterator iterator;
+		CHECKER_LOG(common::CheckerName::danglingPointer, 1, *configure, "-------------VarInfo--------");
+        VarInfoList::iterator iterator;
         for(iterator = vis.begin(); iterator != vis.end(); ++iterator)
         {
             if(iterator->freeLike)
-				common::printLog(iterator->varName + "->" + iterator->freeLike->funName + "\n", common::CheckerName::danglingPointer, 1, *configure);
+				CHECKER_LOG(common::CheckerName::danglingPointer, 1, *configure, iterator->varName + "->" + iterator->freeLike->funName + "\n");
             else
-				common::printLog(iterator->varName + "->" + iterator->freeLike->funName + "\n", common::CheckerName::danglingPointer, 1, *configure);
+				CHECKER_LOG(common::CheckerName::danglingPointer, 1, *configure, iterator->varName + "->" + iterator->freeLike->funName + "\n");
         }
     }
     if(ifFun)
     {
-		common::printLog("-------------FunInfo--------", common::CheckerName::danglingPointer, 1, *configure);
-        list<FunInfo>::iterator fiterator;
+		CHECKER_LOG(common::CheckerName::danglingPointer, 1, *configure, "-------------FunInfo--------");
+        FunInfoList::iterator fiterator;
         for(fiterator = fis.begin(); fiterator != fis.end(); ++fiterator)
         {
             if(fiterator->parent)
-				common::printLog(fiterator->funName + "->" + fiterator->parent->funName + " var:" + fiterator->var + "\n", common::CheckerName::danglingPointer, 1, *configure);
+				CHECKER_LOG(common::CheckerName::danglingPointer, 1, *configure, fiterator->funName + "->" + fiterator->parent->funName + " var:" + fiterator->var + "\n");
             else
-				common::printLog(fiterator->funName + "->" + fiterator->parent->funName + " var:" + fiterator->var + "\n", common::CheckerName::danglingPointer, 1, *configure);
+				CHECKER_LOG(common::CheckerName::danglingPointer, 1, *configure, fiterator->funName + "->" + fiterator->parent->funName + " var:" + fiterator->var + "\n");
                 //cout<<fiterator->funName<<"->"<<fiterator->parent<<" var:"<<fiterator->var<<endl;
 
         }
     }
-	common::printLog("--------------END-------", common::CheckerName::danglingPointer, 1, *configure);
-
-}
+	CHECKER_LOG(common::CheckerName::danglingPointer, 1, *configure, "--------------END-------");
 
-
-//inner recursive dfs function 
-void DanglingPtr::_DFSTopSort(ASTFunction *i, 
-        std::unordered_map<ASTFunction *, Color>& colors, std::vector<ASTFunction*> &NonTopoOrder){ 
-	colors[i] = GRAY;//vISIT i
-
-   const std::vector<ASTFunction *> children = call_graph->getChildren(i);
-    if (children.size() != 0) {
-	    
-        for (auto child : children) {
-		    //children have not been visited
-	    	if(colors[child] == WHITE){ 
-			    _DFSTopSort(child, colors, NonTopoOrder);
-		    }
-	    }
-    }
-	NonTopoOrder.push_back(i);
-	colors[i] = BLACK;
 }
 
-
-std::vector<ASTFunction *> DanglingPtr::getNonTopoOrder() {
-    
-	std::vector<ASTFunction *> NonTopoOrder;
-    
-	std::vector<ASTFunction *> topLevelFuncs = call_graph->getTopLevelFunctions();
-
-    std::unordered_map<ASTFunction *, Color> colors; 
-
-	//init colors
-	for (auto func : resource->getFunctions()) {  
-		colors[func] = WHITE;
-	}
-
-	for (auto topLevelF : topLevelFuncs){
-		_DFSTopSort(topLevelF, colors, NonTopoOrder);
-	}
-
-    return NonTopoOrder;
-}
@@ -2,7 +2,11 @@
 #include <iostream>
 #include <string>
 #include <list>
+#include <map>
+#include <set>
 #include <queue>
+#include <algorithm>
+#include <chrono>
 
 #include "clang/AST/AST.h"
 #include "clang/AST/ASTConsumer.h"
@@ -20,7 +24,20 @@
 #include "clang/Tooling/CommonOptionsParser.h"
 
 #include "../framework/BasicChecker.h"
-#include "../pugixml/pugixml.hpp"
+#include "../framework/CFGVisitor.h"
+#include "../framework/CheckDriver.h"
+#include "../framework/ASTCache.h"
+#include "../framework/DataFlow.h"
+#include "../framework/UnionFind.h"
+#include "../framework/PointsTo.h"
+#include "../framework/Tracer.h"
+#include "../framework/Metrics.h"
+#include "../framework/CountingAllocator.h"
+#include "../framework/SpillStore.h"
+#include "../framework/Profile.h"
+#include "FunctionSummary.h"
+#include "Checkpoint.h"
+#include "ReportWriter.h"
 
 using namespace clang;
 using namespace llvm;
@@ -28,8 +45,6 @@ using namespace clang::driver;
 using namespace clang::tooling;
 using namespace std;
 
-enum Color{WHITE,BLACK,GRAY};
-
 class FunInfo{
 public:
     string funName;
@@ -43,6 +58,7 @@ public:
     int refCount;
     FunInfo(string name, int arg, int ttl, string loc, int line = 0);
     FunInfo(string name, string varName, int ttl, string loc, int line = 0);
+    FunInfo(const TraceFrame &frame, int arg, string varName, int ttl);
 };
 
 
@@ -52,9 +68,10 @@ public:
     bool ifFree;
     bool ifNulled;
     bool ifStatic;
-    VarInfo* alias;
-	//this is used to delete alia relationships.
-	list<VarInfo*> preAlias;
+    //set of the variable in aliasSets, NOALIAS before it is assigned or assigned to
+    unsigned aliasSet;
+    //the variable is assigned another tracked variable, "p = q"
+    bool ifAlias;
     FunInfo* freeLike;
     string loc;
     string file;
@@ -64,40 +81,184 @@ public:
     VarInfo(string varName, bool ifFree, bool ifStatic, string loc, string fun);
 };
 
+//the lists of a function, their memory is accounted to the checker.
+typedef list<VarInfo, CountingAllocator<VarInfo, Metrics::MEMORY_CHECKER>> VarInfoList;
+typedef list<FunInfo, CountingAllocator<FunInfo, Metrics::MEMORY_CHECKER>> FunInfoList;
+
+//a statement freeing, nulling or assigning a pointer, in the order of its CFG block.
+class FreeEvent {
+public:
+    enum Kind{FREE, NULLIFY, ASSIGN};
+    const CFGBlock* block;
+    unsigned index;
+    unsigned var;
+    Kind kind;
+    FreeEvent(const CFGBlock* block, unsigned index, unsigned var, Kind kind):block(block), index(index), var(var), kind(kind){};
+};
+
+//an assignment of the function, handled after the CFG walk.
+class PendingAssign {
+public:
+    const BinaryOperator* expr;
+    const CFGBlock* block;
+    unsigned index;
+    PendingAssign(const BinaryOperator* expr, const CFGBlock* block, unsigned index):expr(expr), block(block), index(index){};
+};
+
 class DanglingPtr:public BasicChecker{
 public:
-	DanglingPtr(ASTResource *resource, ASTManager *manager, CallGraph *call_graph, Config *configure):BasicChecker(resource, manager, call_graph, configure){};
-	void check();
+	DanglingPtr(ASTResource *resource, ASTManager *manager, CallGraph *call_graph, Config *configure);
+	unsigned beginCheck();
+	BasicChecker *fork(ASTManager *manager);
+	void endWavefront(unsigned wavefront);
+	void endCheck();
+	void subscribe(CFGVisitor &visitor);
+	bool beginFunction(ASTFunction *F, LazyFunction &function);
+	void endFunction(ASTFunction *F, FunctionDecl *f, const CFG &cfg);
+	//functions over a budget, with the reason, sorted by name
+	const std::vector<std::string>& getDegraded() const;
+	//number of free-like chains that went deeper than levelOfDete
+	unsigned getDeepenedChains() const;
+	//keep the summaries in memory between runs of check, and the warnings of the last run
+	void setResident();
+	//warnings of the last run of a resident checker, in report order
+	const std::vector<Warning>& getWarnings() const;
 private:
-    list<VarInfo> vis;
-    list<FunInfo> fis;
+	friend class DegradedSummaryVisitor;
+	//the checker of another worker of the CheckDriver, with its own ASTManager.
+	DanglingPtr(DanglingPtr *checker, ASTManager *manager);
+
+    VarInfoList vis;
+    FunInfoList fis;
     //Config
     int levelOfDete;
+    //adaptive: chains still unresolved at levelOfDete go on up to maxLevelOfDete
+    bool ifAdaptiveLevel;
+    int maxLevelOfDete;
+    unsigned deepenedChains;
     bool ifRegardParAsFreelike; //f(a){free(a);};fb{f(a);a=null;} false means ignore this situation.
 
     int warningCount;
 	//ifCalled:  [callee, line]
     std::unordered_map<std::string, int> ifCalled;
-	pugi::xml_document doc;
+	//the reports of reportFormat, written as warnings are emitted
+	std::vector<std::string> reportFormats;
+	std::vector<std::unique_ptr<ReportWriter>> reports;
 	std::unordered_map<std::string, int> memoryReleaseFuns;
-	std::unordered_map<FunInfo*, bool> reportedFun;
+	bool ifReleaseDelete;
+	//reportedFun: [release site of a free-like chain, reported]
+	std::unordered_map<std::string, bool> reportedFun;
+	bool ifResident;
+	std::vector<Warning> emitted;
+
+	//summaries of analyzed functions, computed bottom-up and shared by the workers
+	SummaryTable* summaryTable;
+	std::unique_ptr<SummaryTable> table;
+	SummaryCache summaryCache;
+	//with points-to, cache is noCache, which is never enabled
+	SummaryCache noCache;
+	SummaryCache* cache;
+	uint64_t configHash;
+	//the function being analyzed and the summary built for it, with its key in the cache
+	ASTFunction* curFunction;
+	FunctionSummary* curSummary;
+	FunctionSummary functionSummary;
+	uint64_t summaryKey;
+	//FunInfo chains of the callee effects applied in the current function
+	std::unordered_map<const SummaryEffect*, FunInfo*> appliedEffects;
+	//ids of the variables of the current function, the first ones are ASTFunction::getVariables()
+	std::unordered_map<std::string, unsigned> varIDs;
+	unsigned varCount;
+	//free events of the current function, and the CFG element being visited
+	std::vector<FreeEvent> freeEvents;
+	const CFGBlock* curBlock;
+	unsigned curIndex;
+	//the function being walked and its assignments
+	FunctionDecl* curDecl;
+	std::vector<PendingAssign> assignments;
+	LangOptions LangOpts;
+	PrintingPolicy Policy;
+	//alias classes of the current function, and the variable of each element
+	UnionFind aliasSets;
+	std::vector<VarInfo*> aliasOwners;
+	//whole-program points-to, nullptr unless pointsTo is set in the config
+	bool ifPointsTo;
+	const PointsTo* pointsTo;
+	std::unique_ptr<PointsTo> program;
+	//budgets of a function, 0 for no limit. maxTime is in milliseconds.
+	unsigned maxBlocks;
+	unsigned maxStatements;
+	unsigned maxTime;
+	//end of the time budget of the current function
+	std::chrono::steady_clock::time_point deadline;
+	unsigned timeChecks;
+	bool ifOverTime;
+	std::vector<std::string> degraded;
+	//FREE_GLOBAL effects found in the AST of a function over budget, and the globals it nulls anywhere
+	std::vector<SummaryEffect> degradedGlobals;
+	std::set<std::string> degradedNulls;
+	//seconds between flushes of the checkpoint, 0 for no checkpoint
+	unsigned checkpointInterval;
+	bool ifResume;
+	std::unique_ptr<Checkpoint> checkpoint;
+	//summaries kept in memory before the cold ones are spilled to disk, 0 for no limit
+	unsigned residentSummaries;
+	SpillStore spillStore;
+	//functions whose summary is cold after each wavefront, i.e. all their callers are analyzed
+	std::vector<std::vector<unsigned>> coldAfter;
+	std::vector<unsigned> cold;
+	unsigned resident;
+	//the top profileTop functions by cost are written to profile.json, 0 for no profile
+	unsigned profileTop;
+	Profile* profile;
+	std::unique_ptr<Profile> functionCosts;
+	//the cost of the current function, from beginFunction to endFunction
+	FunctionCost cost;
+	unsigned costReloads;
+	std::chrono::steady_clock::time_point visitStart;
 
     int readConfig(Config &c);
+	int finishFunction(ASTFunction *F, FunctionDecl *f, const string &reason);
+	int resolveFunction(FunctionDecl *f, const CFG &cfg);
+	string overBudget(const FunctionDecl *f);
+	string overBudget(const CFG &cfg);
+	bool overTime(bool force = false);
+	int buildDegradedSummary(FunctionDecl *f);
+	int addDegradedCall(FunctionDecl *f, const CallExpr *call);
+	int addDegradedRelease(FunctionDecl *f, const Expr *arg, const Stmt *release);
+	int addDegradedNull(const FunctionDecl *f, const Expr *lhs, const Expr *rhs);
     int clearLocalVar();
     int ifMemoryFun(string funName);
-    bool VisitFunDecl(FunctionDecl *f, int ttl, const std::unique_ptr<clang::CFG> &myCFG);
+	void VisitCallExpr(const CallExpr *tmp, const CFGBlock *block, unsigned index);
+	void VisitCXXDeleteExpr(const CXXDeleteExpr *tmp, const CFGBlock *block, unsigned index);
+	void VisitBinaryOperator(const BinaryOperator *E, const CFGBlock *block, unsigned index);
     CFG::BuildOptions cfgBuildOptions;
-    int ifStaticVar(string var, list<VarInfo>::iterator *iterator, string loc);
+    int ifStaticVar(string var, VarInfoList::iterator *iterator, string loc);
     int varStateTransform(string lfh, string rfh, FunctionDecl *f, string loc, string fun, Expr* rhs);
     int checkVar(string funName);
-	int finalCheck();
     int reportWarning(VarInfo &tmp, VarInfo* alias = nullptr);
+	int emitWarning(const Warning &warning);
+	uint64_t getSummaryKey(ASTFunction *F);
+	uint64_t getRunKey();
+	unsigned resumeFrom(Checkpoint &checkpoint);
+	unsigned countDeepenedChains();
+	int planSpill();
+	int spillSummaries(unsigned wavefront);
+	int applySummary(FunctionDecl *f, const CallExpr *call, string loc, const PrintingPolicy &Policy);
+	FunInfo* applyEffect(const SummaryEffect &effect);
+	std::vector<TraceFrame> getTrace(FunInfo *freeLike);
+	int markNulled(string varName, string loc);
+	unsigned getVarID(string varName);
+	int addFreeEvent(string varName, FreeEvent::Kind kind);
+	int resolveNulled(const CFG &myCFG);
+	unsigned getAliasSet(VarInfo &var);
+	int addAlias(VarInfo &var, VarInfo &target);
+	uint64_t getPointsToKey(const VarInfo &var);
+	int addProgramAliases();
+	int addNullifiedParam(FunctionDecl *f, const Expr *lhs, const Expr *rhs);
     int getOperLine(string loc);
-	int writingToXML(string file, string fun, string descr, string line);
-	std::string replace_all(string str, const string old_value, const string new_value); 
+	int openReports();
 	int handleMemoryReleaseFun(FunctionDecl *f, string varName, string loc);
 	int addStaticVar(const Expr* expr);
     void printList();
-	void _DFSTopSort(ASTFunction *i, std::unordered_map<ASTFunction*, Color>& colors, std::vector<ASTFunction*> &NonTopoOrder);
-    std::vector<ASTFunction *> getNonTopoOrder();
 };
@@ -0,0 +1,340 @@
+#include "FunctionSummary.h"
+
+#include "../framework/BinaryIO.h"
+#include "../framework/SpillStore.h"
+#include "../framework/Metrics.h"
+#include "../framework/Common.h"
+
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+
+#define SUMMARY_CACHE_MAGIC "SDDSUMC4"
+
+/**
+ * add an effect to the summary.
+ * An effect already in the summary is kept once, with the larger TTL.
+ */
+void FunctionSummary::addEffect(const SummaryEffect &effect) {
+
+    for (SummaryEffect &old : effects) {
+        if (old.kind == effect.kind && old.param == effect.param && old.global == effect.global) {
+            if (effect.TTL > old.TTL) {
+                old = effect;
+            }
+            return;
+        }
+    }
+    effects.push_back(effect);
+}
+
+bool FunctionSummary::freesParam(int param) const {
+
+    for (const SummaryEffect &effect : effects) {
+        if (effect.kind == SummaryEffect::FREE_PARAM && effect.param == param) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FunctionSummary::nullifiesParam(int param) const {
+
+    for (const SummaryEffect &effect : effects) {
+        if (effect.kind == SummaryEffect::NULLIFY_PARAM && effect.param == param) {
+            return true;
+        }
+    }
+    return false;
+}
+
+namespace {
+
+uint64_t getMemory(const std::vector<TraceFrame> &trace) {
+
+    uint64_t bytes = trace.capacity() * sizeof(TraceFrame);
+    for (const TraceFrame &frame : trace) {
+        bytes += frame.fun.capacity() + frame.file.capacity();
+    }
+    return bytes;
+}
+
+} // end of anonymous namespace
+
+uint64_t FunctionSummary::getMemory() const {
+
+    uint64_t bytes = sizeof(FunctionSummary) + degraded.capacity();
+    bytes += effects.capacity() * sizeof(SummaryEffect);
+    for (const SummaryEffect &effect : effects) {
+        bytes += effect.global.capacity() + ::getMemory(effect.trace);
+    }
+    bytes += warnings.capacity() * sizeof(Warning);
+    for (const Warning &warning : warnings) {
+        bytes += warning.file.capacity() + warning.fun.capacity() + warning.desc.capacity()
+            + warning.line.capacity() + warning.root.capacity() + ::getMemory(warning.trace);
+    }
+    return bytes;
+}
+
+uint64_t FunctionSummary::getInterfaceHash() const {
+
+    BinaryWriter out;
+    writeEffects(out);
+    return common::hashString(out.data);
+}
+
+void FunctionSummary::write(BinaryWriter &out) const {
+
+    out.putString(degraded);
+    writeEffects(out);
+    out.put32(warnings.size());
+    for (const Warning &warning : warnings) {
+        out.putString(warning.file);
+        out.putString(warning.fun);
+        out.putString(warning.line);
+        out.putString(warning.root);
+        out.putString(warning.desc);
+        out.put32(warning.trace.size());
+        for (const TraceFrame &frame : warning.trace) {
+            out.putString(frame.fun);
+            out.putString(frame.file);
+            out.put32(frame.line);
+        }
+    }
+}
+
+void FunctionSummary::writeEffects(BinaryWriter &out) const {
+
+    out.put32(effects.size());
+    for (const SummaryEffect &effect : effects) {
+        out.put32(effect.kind);
+        out.put32(effect.param);
+        out.put32(effect.TTL);
+        out.putString(effect.global);
+        out.put32(effect.trace.size());
+        for (const TraceFrame &frame : effect.trace) {
+            out.putString(frame.fun);
+            out.putString(frame.file);
+            out.put32(frame.line);
+        }
+    }
+}
+
+void FunctionSummary::read(BinaryReader &in) {
+
+    degraded = in.getString();
+    uint32_t size = in.get32();
+    for (uint32_t i = 0; i < size && in.isOk(); i++) {
+        SummaryEffect effect;
+        effect.kind = (SummaryEffect::Kind)in.get32();
+        effect.param = (int32_t)in.get32();
+        effect.TTL = (int32_t)in.get32();
+        effect.global = in.getString();
+        uint32_t frames = in.get32();
+        for (uint32_t j = 0; j < frames && in.isOk(); j++) {
+            TraceFrame frame;
+            frame.fun = in.getString();
+            frame.file = in.getString();
+            frame.line = (int32_t)in.get32();
+            effect.trace.push_back(frame);
+        }
+        addEffect(effect);
+    }
+    size = in.get32();
+    for (uint32_t i = 0; i < size && in.isOk(); i++) {
+        Warning warning;
+        warning.file = in.getString();
+        warning.fun = in.getString();
+        warning.line = in.getString();
+        warning.root = in.getString();
+        warning.desc = in.getString();
+        uint32_t frames = in.get32();
+        for (uint32_t j = 0; j < frames && in.isOk(); j++) {
+            TraceFrame frame;
+            frame.fun = in.getString();
+            frame.file = in.getString();
+            frame.line = (int32_t)in.get32();
+            warning.trace.push_back(frame);
+        }
+        addWarning(warning);
+    }
+}
+
+SummaryTable::~SummaryTable() {
+
+    for (const std::unique_ptr<FunctionSummary> &summary : summaries) {
+        if (summary != nullptr) {
+            Metrics::release(Metrics::MEMORY_SUMMARIES, summary->getMemory());
+        }
+    }
+}
+
+void SummaryTable::set(unsigned id, const FunctionSummary &summary) {
+
+    if (summaries[id] != nullptr) {
+        Metrics::release(Metrics::MEMORY_SUMMARIES, summaries[id]->getMemory());
+    }
+    summaries[id].reset(new FunctionSummary(summary));
+    interfaces[id] = summary.getInterfaceHash();
+    Metrics::allocate(Metrics::MEMORY_SUMMARIES, summaries[id]->getMemory());
+}
+
+bool SummaryTable::spill(unsigned id, SpillStore &store) {
+
+    if (summaries[id] == nullptr) {
+        return true;
+    }
+    BinaryWriter out;
+    summaries[id]->write(out);
+    // a summary that could not be written stays in memory
+    if (!store.append(out.data, offsets[id])) {
+        return false;
+    }
+    Metrics::release(Metrics::MEMORY_SUMMARIES, summaries[id]->getMemory());
+    lengths[id] = out.data.size();
+    this->store = &store;
+    summaries[id].reset();
+    return true;
+}
+
+bool SummaryTable::load(unsigned id, FunctionSummary &summary) const {
+
+    if (summaries[id] != nullptr) {
+        summary = *summaries[id];
+        return true;
+    }
+    if (lengths[id] == 0 || store == nullptr) {
+        return false;
+    }
+    std::string data = store->read(offsets[id], lengths[id]);
+    BinaryReader in(data, 0, data.size());
+    summary = FunctionSummary();
+    summary.read(in);
+    return in.isOk();
+}
+
+/**
+ * load the cache file.
+ * A missing file is an empty cache, a file in another format or cut short is ignored.
+ * path : the cache file, it is rewritten by save().
+ */
+bool SummaryCache::load(std::string path) {
+
+    this->path = path;
+    loaded = true;
+
+    std::ifstream fin(path, std::ios::binary);
+    if (!fin.is_open()) {
+        return false;
+    }
+    std::ostringstream content;
+    content << fin.rdbuf();
+    std::string data = content.str();
+    if (data.compare(0, sizeof(SUMMARY_CACHE_MAGIC) - 1, SUMMARY_CACHE_MAGIC) != 0) {
+        return false;
+    }
+
+    // the number of summaries, then each key and its summary
+    BinaryReader in(data, sizeof(SUMMARY_CACHE_MAGIC) - 1, data.size());
+    std::unordered_map<uint64_t, FunctionSummary> cached;
+    uint32_t size = in.get32();
+    for (uint32_t i = 0; i < size && in.isOk(); i++) {
+        uint64_t key = in.get64();
+        cached[key].read(in);
+    }
+    if (!in.isOk()) {
+        return false;
+    }
+    summaries.swap(cached);
+    return true;
+}
+
+/**
+ * write the summaries used by this run back to the cache file.
+ * Summaries of functions that no longer exist are dropped.
+ * The cache is written to a temporary file renamed over the cache file, so a run killed while
+ * saving leaves the previous cache.
+ */
+bool SummaryCache::save() {
+
+    if (!loaded || path == "") {
+        return false;
+    }
+
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream fout(temporary, std::ios::binary | std::ios::trunc);
+        if (!fout.is_open()) {
+            return false;
+        }
+        BinaryWriter out;
+        uint32_t size = 0;
+        for (auto &content : summaries) {
+            if (used.count(content.first) == 0) {
+                continue;
+            }
+            out.put64(content.first);
+            content.second.write(out);
+            size++;
+        }
+        BinaryWriter head;
+        head.put32(size);
+        fout << SUMMARY_CACHE_MAGIC << head.data << out.data;
+        fout.flush();
+        if (!fout.good()) {
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * copy the cached summary of key into summary.
+ * return false if key is not in the cache.
+ */
+bool SummaryCache::lookup(uint64_t key, FunctionSummary &summary) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = summaries.find(key);
+    if (it == summaries.end()) {
+        misses++;
+        return false;
+    }
+    hits++;
+    used.insert(key);
+    summary = it->second;
+    return true;
+}
+
+void SummaryCache::insert(uint64_t key, const FunctionSummary &summary) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+    summaries[key] = summary;
+    used.insert(key);
+}
+
+void SummaryCache::enable() {
+
+    loaded = true;
+}
+
+void SummaryCache::prune() {
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = summaries.begin(); it != summaries.end(); ) {
+        if (used.count(it->first) == 0) {
+            it = summaries.erase(it);
+        }
+        else {
+            it++;
+        }
+    }
+    used.clear();
+    hits = 0;
+    misses = 0;
+}
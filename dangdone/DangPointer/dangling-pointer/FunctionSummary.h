@@ -0,0 +1,252 @@
+#ifndef FUNCTION_SUMMARY_H
+#define FUNCTION_SUMMARY_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <memory>
+#include <mutex>
+
+#include <stdint.h>
+
+class BinaryWriter;
+class BinaryReader;
+class SpillStore;
+
+/**
+ * one frame of a free-like call trace.
+ * The first frame is the function owning the summary, the last one is the release site.
+ */
+class TraceFrame {
+
+public:
+
+    TraceFrame() : line(0) {}
+    TraceFrame(std::string fun, std::string file, int line) : fun(fun), file(file), line(line) {}
+
+    std::string fun;
+    std::string file;
+    int line;
+};
+
+/**
+ * an effect of calling a function, as seen by its callers.
+ */
+class SummaryEffect {
+
+public:
+
+    enum Kind {
+        FREE_PARAM,
+        FREE_GLOBAL,
+        NULLIFY_PARAM
+    };
+
+    SummaryEffect() : kind(FREE_PARAM), param(-1), TTL(0) {}
+    SummaryEffect(Kind kind, int param, std::string global, int TTL) :
+        kind(kind), param(param), global(global), TTL(TTL) {}
+
+    Kind kind;
+    // index of the parameter, -1 for FREE_GLOBAL
+    int param;
+    // name of the global variable, empty for parameter effects
+    std::string global;
+    // how many more callers the effect is propagated to
+    int TTL;
+
+    std::vector<TraceFrame> trace;
+};
+
+/**
+ * a warning as it is written to the report.
+ * root identifies the release site of a free-like chain, it is empty for local warnings.
+ * trace is the free-like chain from the call in fun down to the release site.
+ */
+class Warning {
+
+public:
+
+    std::string file;
+    std::string fun;
+    std::string desc;
+    std::string line;
+    std::string root;
+    std::vector<TraceFrame> trace;
+};
+
+/**
+ * summary of a function: what it frees and nullifies for its callers.
+ * The warnings reported while analyzing the function are kept as well,
+ * so a cached summary can replace the analysis of an unchanged function.
+ */
+class FunctionSummary {
+
+public:
+
+    void addEffect(const SummaryEffect &effect);
+
+    bool freesParam(int param) const;
+    bool nullifiesParam(int param) const;
+
+    const std::vector<SummaryEffect> &getEffects() const {
+        return effects;
+    }
+
+    void addWarning(const Warning &warning) {
+        warnings.push_back(warning);
+    }
+
+    const std::vector<Warning> &getWarnings() const {
+        return warnings;
+    }
+
+    /**
+     * why the summary was built without analyzing the function, empty if it was analyzed.
+     */
+    void setDegraded(std::string reason) {
+        degraded = reason;
+    }
+
+    const std::string &getDegraded() const {
+        return degraded;
+    }
+
+    /**
+     * bytes the summary takes in memory, its strings included.
+     */
+    uint64_t getMemory() const;
+
+    /**
+     * hash of the effects, what callers of the function see of it.
+     */
+    uint64_t getInterfaceHash() const;
+
+    /**
+     * binary form of the summary, for the checkpoint and the spill store.
+     */
+    void write(BinaryWriter &out) const;
+    void read(BinaryReader &in);
+
+private:
+
+    std::vector<SummaryEffect> effects;
+    std::vector<Warning> warnings;
+    std::string degraded;
+
+    void writeEffects(BinaryWriter &out) const;
+};
+
+/**
+ * summaries of the functions of a run, indexed by ASTFunction id.
+ * A function is written only by the worker analyzing it, and read only by workers
+ * of later wavefronts, so the table needs no lock.
+ * A summary no caller will read again can be spilled to disk, get() returns nullptr for it.
+ */
+class SummaryTable {
+
+public:
+
+    SummaryTable(unsigned size) : summaries(size), keys(size, 0), interfaces(size, 0), offsets(size, 0), lengths(size, 0), store(nullptr) {}
+    ~SummaryTable();
+
+    const FunctionSummary *get(unsigned id) const {
+        return summaries[id].get();
+    }
+
+    /**
+     * move the summary of id to store.
+     * false if it could not be written, it is then kept in memory.
+     */
+    bool spill(unsigned id, SpillStore &store);
+
+    /**
+     * a copy of the summary of id, read back from the store if it was spilled.
+     * return false if the function has no summary.
+     */
+    bool load(unsigned id, FunctionSummary &summary) const;
+
+    void set(unsigned id, const FunctionSummary &summary);
+
+    // 0 if the function is not analyzed yet
+    uint64_t getKey(unsigned id) const {
+        return keys[id];
+    }
+
+    void setKey(unsigned id, uint64_t key) {
+        keys[id] = key;
+    }
+
+    // FunctionSummary::getInterfaceHash of the summary, kept when it is spilled
+    uint64_t getInterface(unsigned id) const {
+        return interfaces[id];
+    }
+
+private:
+
+    std::vector<std::unique_ptr<FunctionSummary>> summaries;
+    std::vector<uint64_t> keys;
+    std::vector<uint64_t> interfaces;
+    // place of the spilled summaries in store, length 0 if not spilled
+    std::vector<uint64_t> offsets;
+    std::vector<uint32_t> lengths;
+    SpillStore *store;
+};
+
+/**
+ * on-disk cache of function summaries.
+ * A summary is keyed by a hash of the function's location, source text, expanded body and the
+ * declarations it uses (common::getFunctionHash), the effects of its callees'
+ * summaries and the checker configuration, so a hit means the function and what it sees
+ * of its callees are unchanged.
+ * The file uses the BinaryIO encoding of the checkpoint and is replaced by rename on save.
+ * lookup and insert may be called by several workers at once.
+ */
+class SummaryCache {
+
+public:
+
+    SummaryCache() : loaded(false), hits(0), misses(0) {}
+
+    bool load(std::string path);
+    bool save();
+
+    bool lookup(uint64_t key, FunctionSummary &summary);
+    void insert(uint64_t key, const FunctionSummary &summary);
+
+    /**
+     * keep the summaries in memory only, without a cache file.
+     */
+    void enable();
+
+    /**
+     * drop the summaries not used since the last prune, and count hits and misses again.
+     */
+    void prune();
+
+    bool isEnabled() const {
+        return loaded;
+    }
+
+    unsigned getHits() const {
+        return hits;
+    }
+
+    unsigned getMisses() const {
+        return misses;
+    }
+
+private:
+
+    std::string path;
+    bool loaded;
+
+    unsigned hits;
+    unsigned misses;
+
+    std::mutex mutex;
+    std::unordered_map<uint64_t, FunctionSummary> summaries;
+    std::unordered_set<uint64_t> used;
+};
+
+#endif
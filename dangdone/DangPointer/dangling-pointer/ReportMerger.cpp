@@ -0,0 +1,506 @@
+#include "ReportMerger.h"
+#include "ReportWriter.h"
+
+#include <fstream>
+#include <algorithm>
+#include <functional>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+
+#define REPORT_NAME "MOLINT.POINTER.NULL.SET"
+#define MERGE_CHUNK_SIZE (64 * 1024)
+
+namespace {
+
+/**
+ * text of an element, with the entities pugixml writes replaced.
+ */
+std::string unescape(const std::string &text) {
+
+    std::string result;
+    for (size_t i = 0; i < text.size(); i++) {
+        size_t end;
+        if (text[i] != '&' || (end = text.find(';', i)) == std::string::npos) {
+            result += text[i];
+            continue;
+        }
+        std::string entity = text.substr(i + 1, end - i - 1);
+        if (entity == "amp") {
+            result += '&';
+        }
+        else if (entity == "lt") {
+            result += '<';
+        }
+        else if (entity == "gt") {
+            result += '>';
+        }
+        else if (entity == "quot") {
+            result += '"';
+        }
+        else if (entity == "apos") {
+            result += '\'';
+        }
+        else if (entity.size() > 1 && entity[0] == '#') {
+            bool hex = entity[1] == 'x';
+            result += (char)strtoul(entity.c_str() + (hex ? 2 : 1), nullptr, hex ? 16 : 10);
+        }
+        else {
+            result += text.substr(i, end - i + 1);
+        }
+        i = end;
+    }
+    return result;
+}
+
+std::string getTime(unsigned sec) {
+
+    return std::to_string(sec / 60) + "min" + std::to_string(sec % 60) + "sec";
+}
+
+unsigned parseTime(const std::string &time) {
+
+    unsigned min = 0, sec = 0;
+    sscanf(time.c_str(), "%umin%usec", &min, &sec);
+    return min * 60 + sec;
+}
+
+bool startsWith(const std::string &s, const std::string &prefix) {
+
+    return s.compare(0, prefix.size(), prefix) == 0;
+}
+
+/**
+ * order of the merged report: file, function, line and description.
+ */
+bool lessWarning(const Warning &a, const Warning &b) {
+
+    if (a.file != b.file) {
+        return a.file < b.file;
+    }
+    if (a.fun != b.fun) {
+        return a.fun < b.fun;
+    }
+    int lineA = atoi(a.line.c_str());
+    int lineB = atoi(b.line.c_str());
+    if (lineA != lineB) {
+        return lineA < lineB;
+    }
+    if (a.line != b.line) {
+        return a.line < b.line;
+    }
+    return a.desc < b.desc;
+}
+
+/**
+ * reads a line of the JSONL report, an object of strings, integers and the array of trace frames.
+ */
+class JSONLine {
+
+public:
+
+    JSONLine(const std::string &text) : text(text), pos(0) {}
+
+    bool readWarning(Warning &warning) {
+        bool ok = readObject([&](const std::string &key) {
+            if (key == "file") {
+                return readString(warning.file);
+            }
+            if (key == "function") {
+                return readString(warning.fun);
+            }
+            if (key == "line") {
+                return readNumber(warning.line);
+            }
+            if (key == "description") {
+                return readString(warning.desc);
+            }
+            if (key == "trace") {
+                return readArray([&]() {
+                    TraceFrame frame;
+                    std::string line;
+                    bool frameOk = readObject([&](const std::string &key) {
+                        if (key == "function") {
+                            return readString(frame.fun);
+                        }
+                        if (key == "file") {
+                            return readString(frame.file);
+                        }
+                        if (key == "line") {
+                            return readNumber(line);
+                        }
+                        return skipValue();
+                    });
+                    frame.line = atoi(line.c_str());
+                    warning.trace.push_back(frame);
+                    return frameOk;
+                });
+            }
+            return skipValue();
+        });
+        skipSpace();
+        return ok && pos == text.size();
+    }
+
+private:
+
+    const std::string &text;
+    size_t pos;
+
+    void skipSpace() {
+        while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\r' || text[pos] == '\n')) {
+            pos++;
+        }
+    }
+
+    bool expect(char c) {
+        skipSpace();
+        if (pos >= text.size() || text[pos] != c) {
+            return false;
+        }
+        pos++;
+        return true;
+    }
+
+    bool peek(char c) {
+        skipSpace();
+        return pos < text.size() && text[pos] == c;
+    }
+
+    // the escapes of common::appendJSON and the other short ones
+    bool readString(std::string &value) {
+        if (!expect('"')) {
+            return false;
+        }
+        value.clear();
+        while (pos < text.size() && text[pos] != '"') {
+            char c = text[pos++];
+            if (c != '\\') {
+                value += c;
+                continue;
+            }
+            if (pos >= text.size()) {
+                return false;
+            }
+            c = text[pos++];
+            switch (c) {
+                case 'n': value += '\n'; break;
+                case 'r': value += '\r'; break;
+                case 't': value += '\t'; break;
+                case 'b': value += '\b'; break;
+                case 'f': value += '\f'; break;
+                case 'u':
+                    if (pos + 4 > text.size()) {
+                        return false;
+                    }
+                    value += (char)strtoul(text.substr(pos, 4).c_str(), nullptr, 16);
+                    pos += 4;
+                    break;
+                default: value += c;
+            }
+        }
+        return expect('"');
+    }
+
+    bool readNumber(std::string &value) {
+        skipSpace();
+        size_t start = pos;
+        while (pos < text.size() && (isdigit((unsigned char)text[pos]) || text[pos] == '-' || text[pos] == '+'
+            || text[pos] == '.' || text[pos] == 'e' || text[pos] == 'E')) {
+            pos++;
+        }
+        value = text.substr(start, pos - start);
+        return pos > start;
+    }
+
+    bool readObject(const std::function<bool(const std::string &)> &field) {
+        if (!expect('{')) {
+            return false;
+        }
+        if (peek('}')) {
+            return expect('}');
+        }
+        do {
+            std::string key;
+            if (!readString(key) || !expect(':') || !field(key)) {
+                return false;
+            }
+        } while (expect(','));
+        return expect('}');
+    }
+
+    bool readArray(const std::function<bool()> &element) {
+        if (!expect('[')) {
+            return false;
+        }
+        if (peek(']')) {
+            return expect(']');
+        }
+        do {
+            if (!element()) {
+                return false;
+            }
+        } while (expect(','));
+        return expect(']');
+    }
+
+    bool skipValue() {
+        std::string ignored;
+        if (peek('"')) {
+            return readString(ignored);
+        }
+        if (peek('{')) {
+            return readObject([&](const std::string &) { return skipValue(); });
+        }
+        if (peek('[')) {
+            return readArray([&]() { return skipValue(); });
+        }
+        for (const char *literal : {"true", "false", "null"}) {
+            if (text.compare(pos, strlen(literal), literal) == 0) {
+                pos += strlen(literal);
+                return true;
+            }
+        }
+        return readNumber(ignored);
+    }
+};
+
+} // end of anonymous namespace
+
+bool ReportMerger::addShard(std::string path) {
+
+    if (path != "" && path[path.size() - 1] != '/' && path[path.size() - 1] != '\\') {
+        path += "/";
+    }
+    // a shard without warnings has no report.
+    // The JSONL report has the traces, the XML report is read when a shard has no JSONL report.
+    bool report = readJSONL(path + REPORT_NAME ".jsonl") || readReport(path + REPORT_NAME ".xml");
+    bool time = readTime(path + "time.txt");
+    if (report || time) {
+        shards++;
+    }
+    return report || time;
+}
+
+/**
+ * read the <error> elements of a report in chunks, the report is not loaded as a whole.
+ */
+bool ReportMerger::readReport(std::string path) {
+
+    std::ifstream fin(path, std::ios::binary);
+    if (!fin.is_open()) {
+        return false;
+    }
+
+    Warning warning;
+    bool inError = false;
+    bool inTag = false;
+    std::string tag;
+    std::string text;
+    std::vector<char> chunk(MERGE_CHUNK_SIZE);
+    while (fin.read(chunk.data(), chunk.size()) || fin.gcount() > 0) {
+        for (std::streamsize i = 0; i < fin.gcount(); i++) {
+            char c = chunk[i];
+            if (!inTag) {
+                if (c == '<') {
+                    inTag = true;
+                    tag.clear();
+                }
+                else {
+                    text += c;
+                }
+                continue;
+            }
+            if (c != '>') {
+                tag += c;
+                continue;
+            }
+            inTag = false;
+
+            // <name/> is an element without text
+            bool empty = !tag.empty() && tag[tag.size() - 1] == '/';
+            bool close = !tag.empty() && tag[0] == '/';
+            std::string name = tag.substr(close ? 1 : 0, tag.find_first_of(" /", 1) - (close ? 1 : 0));
+            if (name == "error" && !close) {
+                warning = Warning();
+                inError = true;
+            }
+            else if (name == "error") {
+                addWarning(warning);
+                inError = false;
+            }
+            else if (inError && (close || empty)) {
+                std::string value = empty ? "" : unescape(text);
+                if (name == "file") {
+                    warning.file = value;
+                }
+                else if (name == "function") {
+                    warning.fun = value;
+                }
+                else if (name == "description") {
+                    warning.desc = value;
+                }
+                else if (name == "line") {
+                    warning.line = value;
+                }
+            }
+            text.clear();
+        }
+    }
+    return true;
+}
+
+/**
+ * read the lines of a JSONL report, a line that is not a warning is skipped.
+ */
+bool ReportMerger::readJSONL(std::string path) {
+
+    std::ifstream fin(path, std::ios::binary);
+    if (!fin.is_open()) {
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(fin, line)) {
+        Warning warning;
+        if (JSONLine(line).readWarning(warning)) {
+            addWarning(warning);
+        }
+    }
+    return true;
+}
+
+/**
+ * a free-like chain is reported once for its release site, the last frame of its trace, as
+ * emitWarning does in a run. Of the warnings of a chain, the first in the order of the merged
+ * report is kept, so it does not depend on the order of the shards.
+ * A warning without a trace (local, alias, or read from an XML report) is kept once by its
+ * file, function, line and description.
+ */
+void ReportMerger::addWarning(const Warning &warning) {
+
+    read++;
+    std::string key;
+    if (!warning.trace.empty() && warning.desc.find(" (alias as ") == std::string::npos) {
+        const TraceFrame &site = warning.trace.back();
+        key = site.fun + ":" + site.file + ":" + std::to_string(site.line);
+    }
+    else {
+        key = warning.file + '\0' + warning.fun + '\0' + warning.line + '\0' + warning.desc;
+    }
+    auto inserted = keys.insert(std::make_pair(key, warnings.size()));
+    if (inserted.second) {
+        warnings.push_back(warning);
+    }
+    else if (lessWarning(warning, warnings[inserted.first->second])) {
+        warnings[inserted.first->second] = warning;
+    }
+}
+
+ReportMerger::Phase &ReportMerger::getPhase(std::string name) {
+
+    for (Phase &phase : phases) {
+        if (phase.name == name) {
+            return phase;
+        }
+    }
+    phases.push_back(Phase(name));
+    return phases.back();
+}
+
+/**
+ * add the times of the phases of a shard, and its functions over budget and deepened chains.
+ */
+bool ReportMerger::readTime(std::string path) {
+
+    std::ifstream fin(path);
+    if (!fin.is_open()) {
+        return false;
+    }
+
+    Phase *phase = nullptr;
+    bool inBudget = false;
+    std::string line;
+    while (std::getline(fin, line)) {
+        if (!line.empty() && line[line.size() - 1] == '\r') {
+            line.erase(line.size() - 1);
+        }
+        if (inBudget && startsWith(line, "\t")) {
+            if (degraded.insert(line.substr(1)).second) {
+                phase->degraded.push_back(line.substr(1));
+            }
+            continue;
+        }
+        inBudget = false;
+
+        if (startsWith(line, "Starting ")) {
+            phase = &getPhase(line.substr(9));
+        }
+        else if (startsWith(line, "End of ")) {
+            phase = nullptr;
+        }
+        else if (startsWith(line, "Total time: ")) {
+            total += parseTime(line.substr(12));
+        }
+        else if (phase == nullptr) {
+            continue;
+        }
+        else if (startsWith(line, "Time: ")) {
+            phase->seconds += parseTime(line.substr(6));
+        }
+        else if (startsWith(line, "Functions over budget: ")) {
+            phase->ifBudget = true;
+            inBudget = true;
+        }
+        else if (startsWith(line, "Chains deepened: ")) {
+            phase->ifChains = true;
+            phase->chains += atoi(line.substr(17).c_str());
+        }
+    }
+    return true;
+}
+
+/**
+ * times of time.txt are the sums over the shards, the CPU time the shards took together.
+ */
+bool ReportMerger::write(std::string path) {
+
+    if (path != "" && path[path.size() - 1] != '/' && path[path.size() - 1] != '\\') {
+        path += "/";
+    }
+    std::ofstream process_file(path + "time.txt");
+    if (!process_file.is_open()) {
+        return false;
+    }
+
+    std::sort(warnings.begin(), warnings.end(), lessWarning);
+    std::remove((path + REPORT_NAME ".idx").c_str());
+    XMLReportWriter report(path + REPORT_NAME ".xml");
+    IndexReportWriter index(path + REPORT_NAME ".idx");
+    for (const Warning &warning : warnings) {
+        report.write(warning);
+        index.write(warning);
+    }
+    report.close();
+    index.close();
+
+    process_file << "Merged shards: " << shards << std::endl;
+    for (const Phase &phase : phases) {
+        process_file << "Starting " << phase.name << std::endl;
+        process_file << "Time: " << getTime(phase.seconds) << std::endl;
+        if (phase.ifBudget) {
+            process_file << "Functions over budget: " << phase.degraded.size() << std::endl;
+            for (const std::string &fun : phase.degraded) {
+                process_file << "\t" << fun << std::endl;
+            }
+        }
+        if (phase.ifChains) {
+            process_file << "Chains deepened: " << phase.chains << std::endl;
+        }
+        process_file << "End of " << phase.name << "\n-----------------------------------------------------------" << std::endl;
+    }
+    process_file << "Warnings: " << read << " read, " << warnings.size() << " after merging" << std::endl;
+    process_file << "-----------------------------------------------------------\nTotal time: " << getTime(total) << std::endl;
+    return true;
+}
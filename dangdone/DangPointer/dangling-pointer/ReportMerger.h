@@ -0,0 +1,80 @@
+#ifndef REPORT_MERGER_H
+#define REPORT_MERGER_H
+
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include <unordered_map>
+
+#include "FunctionSummary.h"
+
+/**
+ * merges the outputs of SDDang runs over parts of a program (shards) into one output.
+ * A warning found by several shards, e.g. in a header analyzed by each of them, is kept once:
+ * warnings of a free-like chain are the same when they have the same release site, as in a run,
+ * other warnings when they have the same file, function, line and description,
+ * a run may report several variables on one line.
+ * The merged report is sorted by file, function and line, so it does not depend on the order of the shards.
+ */
+class ReportMerger {
+
+public:
+
+    ReportMerger() : shards(0), read(0), total(0) {}
+
+    /**
+     * read the report and time.txt in the output path of a shard.
+     * return false if the shard has neither.
+     */
+    bool addShard(std::string path);
+
+    /**
+     * write the report, its index and time.txt to path.
+     */
+    bool write(std::string path);
+
+    unsigned getRead() const {
+        return read;
+    }
+
+    unsigned getWarnings() const {
+        return warnings.size();
+    }
+
+private:
+
+    /**
+     * a phase of time.txt, from "Starting name" to "End of name".
+     */
+    class Phase {
+
+    public:
+
+        Phase(std::string name) : name(name), seconds(0), chains(0), ifBudget(false), ifChains(false) {}
+
+        std::string name;
+        unsigned seconds;
+        std::vector<std::string> degraded;
+        unsigned chains;
+        bool ifBudget;
+        bool ifChains;
+    };
+
+    unsigned shards;
+    unsigned read;
+    std::vector<Warning> warnings;
+    // release site, or file, function, line and description, of the warnings kept, to their index
+    std::unordered_map<std::string, unsigned> keys;
+
+    std::vector<Phase> phases;
+    std::unordered_set<std::string> degraded;
+    unsigned total;
+
+    bool readReport(std::string path);
+    bool readJSONL(std::string path);
+    bool readTime(std::string path);
+    void addWarning(const Warning &warning);
+    Phase &getPhase(std::string name);
+};
+
+#endif
@@ -0,0 +1,221 @@
+#include "ReportWriter.h"
+#include "WarningIndex.h"
+#include "../framework/JSON.h"
+
+#include <cstdlib>
+
+// the buffer is written to the file once it is over this size
+#define REPORT_BATCH_SIZE (64 * 1024)
+#define REPORT_CHECKER "MOLINT.POINTER.NULL.SET"
+
+ReportWriter::~ReportWriter() {
+
+    ReportWriter::close();
+}
+
+void ReportWriter::flush() {
+
+    if (buffer.empty()) {
+        return;
+    }
+    if (!fout.is_open()) {
+        fout.open(path, std::ios::binary | std::ios::trunc);
+    }
+    fout.write(buffer.data(), buffer.size());
+    fout.flush();
+    buffer.clear();
+}
+
+void ReportWriter::batch() {
+
+    if (buffer.size() >= REPORT_BATCH_SIZE) {
+        flush();
+    }
+}
+
+void ReportWriter::close() {
+
+    flush();
+    if (fout.is_open()) {
+        fout.close();
+    }
+}
+
+/**
+ * file of the warning with / separators.
+ */
+std::string ReportWriter::getFile(std::string file) {
+
+    for (char &c : file) {
+        if (c == '\\') {
+            c = '/';
+        }
+    }
+    return file;
+}
+
+void XMLReportWriter::write(const Warning &warning) {
+
+    buffer += "<error>\n";
+    writeElement("checker", REPORT_CHECKER);
+    writeElement("domain", "STATIC_C");
+    writeElement("file", getFile(warning.file));
+    writeElement("function", warning.fun);
+    writeElement("score", "100");
+    writeElement("ordered", "false");
+    buffer += "<event>\n";
+    writeElement("main", "true");
+    writeElement("tag", "Error");
+    writeElement("description", warning.desc);
+    writeElement("line", warning.line);
+    buffer += "</event>\n";
+    writeElement("extra", "none");
+    writeElement("subcategory", "none");
+    buffer += "</error>\n";
+    count++;
+    batch();
+}
+
+/**
+ * an element with text, escaped as pugixml escapes pcdata:
+ * &, < and > by entities, control characters other than \t, \n and \r by &#NN;.
+ */
+void XMLReportWriter::writeElement(const char *name, const std::string &text) {
+
+    buffer += '<';
+    buffer += name;
+    buffer += '>';
+    for (char c : text) {
+        unsigned char ch = (unsigned char)c;
+        if (c == '&') {
+            buffer += "&amp;";
+        }
+        else if (c == '<') {
+            buffer += "&lt;";
+        }
+        else if (c == '>') {
+            buffer += "&gt;";
+        }
+        else if (ch < 32 && c != '\t' && c != '\n' && c != '\r') {
+            buffer += "&#";
+            buffer += (char)('0' + ch / 10);
+            buffer += (char)('0' + ch % 10);
+            buffer += ';';
+        }
+        else {
+            buffer += c;
+        }
+    }
+    buffer += "</";
+    buffer += name;
+    buffer += ">\n";
+}
+
+void SARIFReportWriter::writeHeader() {
+
+    buffer += "{\n\"$schema\": \"https://json.schemastore.org/sarif-2.1.0.json\",\n\"version\": \"2.1.0\",\n";
+    buffer += "\"runs\": [{\n\"tool\": {\"driver\": {\"name\": \"SDDang\", \"rules\": [{\"id\": \"" REPORT_CHECKER "\", ";
+    buffer += "\"shortDescription\": {\"text\": \"A released pointer is not set to NULL.\"}}]}},\n";
+    buffer += "\"results\": [\n";
+}
+
+/**
+ * a location with its function, line 0 has no region.
+ */
+void SARIFReportWriter::writeLocation(const std::string &fun, const std::string &file, int line) {
+
+    buffer += "{\"physicalLocation\": {\"artifactLocation\": {\"uri\": ";
+    common::appendJSON(buffer, file);
+    buffer += "}";
+    if (line > 0) {
+        buffer += ", \"region\": {\"startLine\": " + std::to_string(line) + "}";
+    }
+    buffer += "}, \"logicalLocations\": [{\"fullyQualifiedName\": ";
+    common::appendJSON(buffer, fun);
+    buffer += ", \"kind\": \"function\"}]}";
+}
+
+/**
+ * the code flow goes from the warning to the release site, through the free-like functions called.
+ */
+void SARIFReportWriter::write(const Warning &warning) {
+
+    if (count == 0) {
+        writeHeader();
+    }
+    else {
+        buffer += ",\n";
+    }
+
+    std::string file = getFile(warning.file);
+    int line = atoi(warning.line.c_str());
+    buffer += "{\"ruleId\": \"" REPORT_CHECKER "\", \"level\": \"error\", \"message\": {\"text\": ";
+    common::appendJSON(buffer, warning.desc);
+    buffer += "},\n\"locations\": [";
+    writeLocation(warning.fun, file, line);
+    buffer += "]";
+    if (!warning.trace.empty()) {
+        buffer += ",\n\"codeFlows\": [{\"threadFlows\": [{\"locations\": [\n{\"location\": ";
+        writeLocation(warning.fun, file, line);
+        buffer += "}";
+        for (const TraceFrame &frame : warning.trace) {
+            buffer += ",\n{\"location\": ";
+            writeLocation(frame.fun, getFile(frame.file), frame.line);
+            buffer += "}";
+        }
+        buffer += "]}]}]";
+    }
+    buffer += "}";
+    count++;
+    batch();
+}
+
+void SARIFReportWriter::close() {
+
+    if (closed) {
+        return;
+    }
+    if (count == 0) {
+        writeHeader();
+    }
+    buffer += "\n]\n}]\n}\n";
+    closed = true;
+    ReportWriter::close();
+}
+
+void JSONLReportWriter::write(const Warning &warning) {
+
+    buffer += "{\"checker\": \"" REPORT_CHECKER "\", \"file\": ";
+    common::appendJSON(buffer, getFile(warning.file));
+    buffer += ", \"function\": ";
+    common::appendJSON(buffer, warning.fun);
+    buffer += ", \"line\": " + std::to_string(atoi(warning.line.c_str())) + ", \"description\": ";
+    common::appendJSON(buffer, warning.desc);
+    buffer += ", \"trace\": [";
+    for (unsigned i = 0; i < warning.trace.size(); i++) {
+        const TraceFrame &frame = warning.trace[i];
+        buffer += i == 0 ? "{\"function\": " : ", {\"function\": ";
+        common::appendJSON(buffer, frame.fun);
+        buffer += ", \"file\": ";
+        common::appendJSON(buffer, getFile(frame.file));
+        buffer += ", \"line\": " + std::to_string(frame.line) + "}";
+    }
+    buffer += "]}\n";
+    count++;
+    batch();
+}
+
+void IndexReportWriter::write(const Warning &warning) {
+
+    functions[warning.fun].push_back(atoi(warning.line.c_str()));
+    count++;
+}
+
+void IndexReportWriter::close() {
+
+    if (!functions.empty()) {
+        buffer = WarningIndex::build(functions);
+        functions.clear();
+    }
+    ReportWriter::close();
+}
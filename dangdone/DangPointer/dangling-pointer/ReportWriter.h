@@ -0,0 +1,125 @@
+#ifndef REPORT_WRITER_H
+#define REPORT_WRITER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+
+#include "FunctionSummary.h"
+
+/**
+ * a report file written as warnings are emitted.
+ * Warnings are buffered and written to the file in batches, the file is created
+ * with the first batch. close() must be called to complete the file.
+ */
+class ReportWriter {
+
+public:
+
+    ReportWriter(std::string path) : count(0), path(path) {}
+    virtual ~ReportWriter();
+
+    virtual void write(const Warning &warning) = 0;
+    virtual void close();
+
+    /**
+     * write the buffered warnings to the file.
+     */
+    void flush();
+
+    unsigned getCount() const {
+        return count;
+    }
+
+protected:
+
+    std::string buffer;
+    unsigned count;
+
+    /**
+     * flush once the buffer is over the batch size.
+     */
+    void batch();
+
+    static std::string getFile(std::string file);
+
+private:
+
+    std::string path;
+    std::ofstream fout;
+
+    ReportWriter(const ReportWriter&);
+    ReportWriter& operator =(const ReportWriter&);
+};
+
+/**
+ * the MOLINT XML report.
+ * The output is byte for byte what pugixml saves for the same DOM with format_no_declaration
+ * (one element per line, no indent), so the NoDang pass reads it as before.
+ * A run without warnings writes no file.
+ */
+class XMLReportWriter : public ReportWriter {
+
+public:
+
+    XMLReportWriter(std::string path) : ReportWriter(path) {}
+
+    void write(const Warning &warning);
+
+private:
+
+    void writeElement(const char *name, const std::string &text);
+};
+
+/**
+ * a SARIF 2.1.0 log with one run, the call trace of a warning is its code flow.
+ */
+class SARIFReportWriter : public ReportWriter {
+
+public:
+
+    SARIFReportWriter(std::string path) : ReportWriter(path), closed(false) {}
+
+    void write(const Warning &warning);
+    void close();
+
+private:
+
+    bool closed;
+
+    void writeHeader();
+    void writeLocation(const std::string &fun, const std::string &file, int line);
+};
+
+/**
+ * one JSON object per warning and line, so the file can be read while it is written.
+ */
+class JSONLReportWriter : public ReportWriter {
+
+public:
+
+    JSONLReportWriter(std::string path) : ReportWriter(path) {}
+
+    void write(const Warning &warning);
+};
+
+/**
+ * the WarningIndex of the functions and lines of the report, written by close().
+ * As the XML report, a run without warnings writes no file.
+ */
+class IndexReportWriter : public ReportWriter {
+
+public:
+
+    IndexReportWriter(std::string path) : ReportWriter(path) {}
+
+    void write(const Warning &warning);
+    void close();
+
+private:
+
+    std::map<std::string, std::vector<unsigned>> functions;
+};
+
+#endif
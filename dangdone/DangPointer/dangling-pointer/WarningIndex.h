@@ -0,0 +1,230 @@
+#ifndef WARNING_INDEX_H
+#define WARNING_INDEX_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define WARNING_INDEX_MAGIC "SDDWIDX1"
+#define WARNING_INDEX_HEADER 16
+#define WARNING_INDEX_SLOT 24
+#define WARNING_INDEX_EMPTY 0xffffffffu
+
+/**
+ * a hashed index of the functions with warnings and their lines.
+ * SDDang writes it next to the XML report and the NoDang pass maps it, so a compilation unit
+ * looks its functions up without parsing the report. The file is read in place, it is not copied.
+ * The header is used by both sides, a copy is kept in dangdone/src as for pugixml.
+ *
+ * Layout, little-endian:
+ *   "SDDWIDX1", u32 number of slots (a power of 2), u32 number of lines
+ *   slots of {u64 hash, u32 name, u32 name length, u32 first line, u32 number of lines},
+ *   the name of an empty slot is WARNING_INDEX_EMPTY
+ *   the lines, sorted for each function
+ *   the names
+ */
+class WarningIndex {
+
+public:
+
+    WarningIndex() : data(nullptr), size(0), slots(0), lines(0) {}
+
+    ~WarningIndex() {
+        close();
+    }
+
+    /**
+     * FNV-1a, the same as common::hashString of SDDang.
+     */
+    static uint64_t hash(const std::string &s) {
+        uint64_t hash = 14695981039346656037ULL;
+        for (unsigned char c : s) {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    /**
+     * the content of an index of functions: [function, lines of its warnings].
+     */
+    static std::string build(const std::map<std::string, std::vector<unsigned>> &functions) {
+        uint32_t slots = 1;
+        // at most half of the slots are used, so probes stay short
+        while (slots < functions.size() * 2) {
+            slots *= 2;
+        }
+        std::string table(slots * WARNING_INDEX_SLOT, '\0');
+        for (uint32_t i = 0; i < slots; i++) {
+            put32(table, i * WARNING_INDEX_SLOT + 8, WARNING_INDEX_EMPTY);
+        }
+        std::string lineData;
+        std::string names;
+        uint32_t lineCount = 0;
+        for (auto &function : functions) {
+            uint64_t h = hash(function.first);
+            uint32_t i = h & (slots - 1);
+            while (get32(table.data() + i * WARNING_INDEX_SLOT + 8) != WARNING_INDEX_EMPTY) {
+                i = (i + 1) & (slots - 1);
+            }
+            std::vector<unsigned> sorted(function.second);
+            std::sort(sorted.begin(), sorted.end());
+            sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+            size_t slot = i * WARNING_INDEX_SLOT;
+            put32(table, slot, (uint32_t)h);
+            put32(table, slot + 4, (uint32_t)(h >> 32));
+            put32(table, slot + 8, names.size());
+            put32(table, slot + 12, function.first.size());
+            put32(table, slot + 16, lineCount);
+            put32(table, slot + 20, sorted.size());
+            for (unsigned line : sorted) {
+                lineData.append(4, '\0');
+                put32(lineData, lineData.size() - 4, line);
+            }
+            lineCount += sorted.size();
+            names += function.first;
+        }
+        std::string header(WARNING_INDEX_MAGIC);
+        header.append(8, '\0');
+        put32(header, 8, slots);
+        put32(header, 12, lineCount);
+        return header + table + lineData + names;
+    }
+
+    /**
+     * map the index at path, false if it is missing or not a valid index.
+     */
+    bool open(const std::string &path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd == -1) {
+            return false;
+        }
+        struct stat status;
+        if (fstat(fd, &status) != 0 || status.st_size < WARNING_INDEX_HEADER) {
+            ::close(fd);
+            return false;
+        }
+        void *address = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (address == MAP_FAILED) {
+            return false;
+        }
+        data = (const char *)address;
+        size = status.st_size;
+
+        slots = get32(data + 8);
+        lines = get32(data + 12);
+        uint64_t end = WARNING_INDEX_HEADER + (uint64_t)slots * WARNING_INDEX_SLOT + (uint64_t)lines * 4;
+        if (std::string(data, 8) != WARNING_INDEX_MAGIC || slots == 0 || (slots & (slots - 1)) != 0 || end > size) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    bool isOpen() const {
+        return data != nullptr;
+    }
+
+    void close() {
+        if (data != nullptr) {
+            munmap((void *)data, size);
+            data = nullptr;
+        }
+        size = 0;
+        slots = 0;
+        lines = 0;
+    }
+
+    bool contains(const std::string &fun) const {
+        return find(fun) != nullptr;
+    }
+
+    /**
+     * whether fun has a warning at line.
+     */
+    bool contains(const std::string &fun, unsigned line) const {
+        const char *slot = find(fun);
+        if (slot == nullptr) {
+            return false;
+        }
+        uint32_t first = get32(slot + 16);
+        uint32_t count = get32(slot + 20);
+        if ((uint64_t)first + count > lines) {
+            return false;
+        }
+        const char *base = data + WARNING_INDEX_HEADER + (uint64_t)slots * WARNING_INDEX_SLOT;
+        uint32_t low = first, high = first + count;
+        while (low < high) {
+            uint32_t middle = low + (high - low) / 2;
+            uint32_t value = get32(base + middle * 4);
+            if (value == line) {
+                return true;
+            }
+            if (value < line) {
+                low = middle + 1;
+            }
+            else {
+                high = middle;
+            }
+        }
+        return false;
+    }
+
+private:
+
+    const char *data;
+    uint64_t size;
+    uint32_t slots;
+    uint32_t lines;
+
+    static uint32_t get32(const char *p) {
+        const unsigned char *u = (const unsigned char *)p;
+        return u[0] | (u[1] << 8) | (u[2] << 16) | ((uint32_t)u[3] << 24);
+    }
+
+    static void put32(std::string &s, size_t pos, uint32_t value) {
+        for (int i = 0; i < 4; i++) {
+            s[pos + i] = (char)(value >> (i * 8));
+        }
+    }
+
+    /**
+     * the slot of fun, nullptr if it has no warning.
+     */
+    const char *find(const std::string &fun) const {
+        if (data == nullptr) {
+            return nullptr;
+        }
+        uint64_t h = hash(fun);
+        const char *names = data + WARNING_INDEX_HEADER + (uint64_t)slots * WARNING_INDEX_SLOT + (uint64_t)lines * 4;
+        for (uint32_t i = h & (slots - 1), probes = 0; probes < slots; i = (i + 1) & (slots - 1), probes++) {
+            const char *slot = data + WARNING_INDEX_HEADER + (uint64_t)i * WARNING_INDEX_SLOT;
+            uint32_t name = get32(slot + 8);
+            if (name == WARNING_INDEX_EMPTY) {
+                return nullptr;
+            }
+            uint64_t slotHash = get32(slot) | ((uint64_t)get32(slot + 4) << 32);
+            uint32_t length = get32(slot + 12);
+            if (slotHash == h && length == fun.size() && names + name + length <= data + size
+                    && fun.compare(0, length, names + name, length) == 0) {
+                return slot;
+            }
+        }
+        return nullptr;
+    }
+
+    WarningIndex(const WarningIndex&);
+    WarningIndex& operator =(const WarningIndex&);
+};
+
+#endif
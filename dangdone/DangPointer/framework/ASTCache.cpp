@@ -0,0 +1,158 @@
+#include "ASTCache.h"
+#include "Common.h"
+#include "Metrics.h"
+#include "Tracer.h"
+
+#include <fstream>
+
+#include <sys/stat.h>
+
+#define AST_CACHE_CHUNK_SIZE (1024 * 1024)
+
+std::mutex ASTCache::mutex;
+unsigned ASTCache::capacity = 0;
+std::list<ASTCache::Idle> ASTCache::idle;
+std::unordered_map<const ASTUnit *, ASTCache::Unit> ASTCache::units;
+std::unordered_map<std::string, ASTCache::Stamp> ASTCache::stamps;
+
+void ASTCache::open(unsigned size) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+    capacity = size;
+}
+
+/**
+ * the ASTs kept are deleted, the ASTUnits still used by managers are deleted by them.
+ */
+void ASTCache::close() {
+
+    std::lock_guard<std::mutex> lock(mutex);
+    while (!idle.empty()) {
+        erase(idle.begin());
+    }
+    capacity = 0;
+    stamps.clear();
+}
+
+/**
+ * the ASTs of a batch are hashed once however many projects list them.
+ */
+uint64_t ASTCache::getContent(const std::string &AST) {
+
+    struct stat status;
+    if (stat(AST.c_str(), &status) != 0) {
+        return 0;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = stamps.find(AST);
+        if (it != stamps.end() && it->second.size == (uint64_t)status.st_size && it->second.modified == status.st_mtime) {
+            return it->second.content;
+        }
+    }
+
+    TRACE_SPAN(span, "hashAST", "ast", "ast", AST);
+    std::ifstream fin(AST, std::ios::binary);
+    uint64_t content = common::hashString("");
+    std::string chunk(AST_CACHE_CHUNK_SIZE, '\0');
+    while (fin.read(&chunk[0], chunk.size()) || fin.gcount() > 0) {
+        // only the last chunk is short
+        if (fin.gcount() < (std::streamsize)chunk.size()) {
+            chunk.resize(fin.gcount());
+        }
+        content = common::hashString(chunk, content);
+    }
+    content = common::hashCombine(content, status.st_size);
+
+    Stamp stamp;
+    stamp.size = status.st_size;
+    stamp.modified = status.st_mtime;
+    stamp.content = content;
+    std::lock_guard<std::mutex> lock(mutex);
+    stamps[AST] = stamp;
+    return content;
+}
+
+std::unique_ptr<ASTUnit> ASTCache::load(const std::string &AST) {
+
+    if (!isEnabled()) {
+        return common::loadFromASTFile(AST);
+    }
+
+    uint64_t content = getContent(AST);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = idle.begin(); content != 0 && it != idle.end(); it++) {
+            if (units[it->AU.get()].content != content) {
+                continue;
+            }
+            std::unique_ptr<ASTUnit> AU = std::move(it->AU);
+            Metrics::release(Metrics::MEMORY_AST, it->bytes);
+            idle.erase(it);
+            Metrics::add(Metrics::AST_CACHE_HITS);
+            return AU;
+        }
+    }
+
+    Metrics::add(Metrics::AST_CACHE_MISSES);
+    std::unique_ptr<ASTUnit> AU = common::loadFromASTFile(AST);
+    if (AU != nullptr && content != 0) {
+        std::lock_guard<std::mutex> lock(mutex);
+        units[AU.get()].content = content;
+    }
+    return AU;
+}
+
+/**
+ * an AST given back is the most recently used, the least recently used is deleted when the cache is full.
+ * An AST whose file could not be hashed is not kept.
+ */
+void ASTCache::unload(std::unique_ptr<ASTUnit> AU, uint64_t bytes) {
+
+    if (AU == nullptr) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    auto unit = units.find(AU.get());
+    if (unit == units.end()) {
+        return;
+    }
+    if (capacity == 0) {
+        units.erase(unit);
+        return;
+    }
+    if (idle.size() == capacity) {
+        erase(idle.begin());
+    }
+    Metrics::allocate(Metrics::MEMORY_AST, bytes);
+    idle.push_back(Idle(std::move(AU), bytes));
+}
+
+void ASTCache::erase(std::list<Idle>::iterator it) {
+
+    Metrics::release(Metrics::MEMORY_AST, it->bytes);
+    units.erase(it->AU.get());
+    idle.erase(it);
+}
+
+bool ASTCache::getReleaseDecls(const ASTUnit *AU, uint64_t key, std::vector<std::pair<const FunctionDecl *, int>> &decls) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = units.find(AU);
+    if (it == units.end() || it->second.releaseKey != key || key == 0) {
+        return false;
+    }
+    decls = it->second.releaseDecls;
+    return true;
+}
+
+void ASTCache::setReleaseDecls(const ASTUnit *AU, uint64_t key, const std::vector<std::pair<const FunctionDecl *, int>> &decls) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = units.find(AU);
+    if (it == units.end()) {
+        return;
+    }
+    it->second.releaseKey = key;
+    it->second.releaseDecls = decls;
+}
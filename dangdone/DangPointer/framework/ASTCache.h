@@ -0,0 +1,119 @@
+#ifndef AST_CACHE_H
+#define AST_CACHE_H
+
+#include <string>
+#include <vector>
+#include <list>
+#include <mutex>
+#include <memory>
+#include <unordered_map>
+
+#include <stdint.h>
+
+#include <clang/Frontend/ASTUnit.h>
+
+using namespace clang;
+
+/**
+ * deserialized ASTs kept between the runs of a batch, by the hash of the content of their file,
+ * so an AST listed by several projects (e.g. of a common library) is deserialized once.
+ * A manager takes an AST from the cache when it loads it and gives it back when it evicts it,
+ * an ASTUnit is never used by two managers at once. The release functions resolved in an AST
+ * are kept with it, they are not searched again for the same MemoryReleaseFunction block.
+ * The cache is off until open(), load() then reads the file and unload() deletes the ASTUnit.
+ */
+class ASTCache {
+
+public:
+
+    /**
+     * keep up to capacity ASTs not used by a manager.
+     */
+    static void open(unsigned capacity);
+    static void close();
+
+    static bool isEnabled() {
+        return capacity != 0;
+    }
+
+    /**
+     * an ASTUnit of the file AST, from the cache if an AST with the same content is in it.
+     * It may be called by several threads.
+     */
+    static std::unique_ptr<ASTUnit> load(const std::string &AST);
+
+    /**
+     * give back an ASTUnit of load(), bytes is its memory accounted by the manager.
+     */
+    static void unload(std::unique_ptr<ASTUnit> AU, uint64_t bytes);
+
+    /**
+     * the release functions resolved in AU for the MemoryReleaseFunction block of hash key.
+     * false if they were not resolved for it yet.
+     */
+    static bool getReleaseDecls(const ASTUnit *AU, uint64_t key, std::vector<std::pair<const FunctionDecl *, int>> &decls);
+    static void setReleaseDecls(const ASTUnit *AU, uint64_t key, const std::vector<std::pair<const FunctionDecl *, int>> &decls);
+
+    /**
+     * hash of the content of the file AST, 0 if it cannot be read.
+     * It is computed again only when the size or the modification time of the file changed.
+     */
+    static uint64_t getContent(const std::string &AST);
+
+private:
+
+    /**
+     * an ASTUnit from the cache: the content of its file, and its release functions.
+     */
+    class Unit {
+
+    public:
+
+        Unit() : content(0), releaseKey(0) {}
+
+        uint64_t content;
+        uint64_t releaseKey;
+        std::vector<std::pair<const FunctionDecl *, int>> releaseDecls;
+    };
+
+    /**
+     * an ASTUnit not used by a manager, with its accounted memory.
+     */
+    class Idle {
+
+    public:
+
+        Idle(std::unique_ptr<ASTUnit> AU, uint64_t bytes) : AU(std::move(AU)), bytes(bytes) {}
+
+        std::unique_ptr<ASTUnit> AU;
+        uint64_t bytes;
+    };
+
+    /**
+     * the content hash of a file, valid while its size and modification time are the same.
+     */
+    class Stamp {
+
+    public:
+
+        Stamp() : size(0), modified(0), content(0) {}
+
+        uint64_t size;
+        int64_t modified;
+        uint64_t content;
+    };
+
+    static std::mutex mutex;
+    static unsigned capacity;
+    // the ASTs not used, least recently given back first
+    static std::list<Idle> idle;
+    // the ASTUnits given by load() and not deleted yet
+    static std::unordered_map<const ASTUnit *, Unit> units;
+    static std::unordered_map<std::string, Stamp> stamps;
+
+    static void erase(std::list<Idle>::iterator it);
+
+    ASTCache();
+};
+
+#endif
@@ -4,6 +4,7 @@
 
 #include <string>
 #include <vector>
+#include <atomic>
 
 #include "Common.h"
 
@@ -32,6 +33,10 @@ public:
         return functions;
     }
 
+    void clearFunctions() {
+        functions.clear();
+    }
+
 private:
     
     unsigned id;
@@ -78,7 +83,7 @@ class ASTFunction : public ASTElement {
 public:
 
     ASTFunction(unsigned id, FunctionDecl *FD, ASTFile *AF, bool use = true) :
-        ASTElement(id, FD->getNameAsString(), AF) {
+        ASTElement(id, FD->getNameAsString(), AF), hash(0) {
         
 		this->use = use;
 
@@ -98,6 +103,18 @@ public:
         return fullName;
     }
 
+    /**
+     * hash of the function's name, location, source text and what it uses.
+     * It is 0 until ASTManager::getFunctionHash computes it, only the summary cache needs it.
+     */
+    uint64_t getHash() const {
+        return hash.load(std::memory_order_relaxed);
+    }
+
+    void setHash(uint64_t hash) {
+        this->hash.store(hash, std::memory_order_relaxed);
+    }
+
     const std::vector<ASTVariable *> &getVariables() const {
         return variables;
     }
@@ -106,10 +123,15 @@ public:
 		return use;
 	}
 
+	void setUse(bool use) {
+		this->use = use;
+	}
+
 private:
 
     std::string fullName;
     unsigned param_size;
+    std::atomic<uint64_t> hash;
     
 	bool use;
 
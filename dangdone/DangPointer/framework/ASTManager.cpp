@@ -1,9 +1,41 @@
 
 #include "Common.h"
 #include "ASTManager.h"
+#include "ASTCache.h"
+#include "Tracer.h"
+#include "Metrics.h"
+#include "PipelineQueue.h"
+
+#include <map>
+#include <atomic>
+#include <algorithm>
+#include <thread>
 
 #include "clang/Frontend/CompilerInstance.h"
 
+namespace {
+
+/**
+ * memory of an ASTUnit: its AST nodes, the side tables of its context and its source manager.
+ */
+uint64_t getASTBytes(ASTUnit *AU) {
+
+    const ASTContext &context = AU->getASTContext();
+    const SourceManager &SM = AU->getSourceManager();
+    return context.getASTAllocatedMemory() + context.getSideTableAllocatedMemory()
+        + SM.getContentCacheSize() + SM.getDataStructureSizes();
+}
+
+/**
+ * memory of a CFG, its blocks and elements are in its allocator.
+ */
+uint64_t getCFGBytes(const std::unique_ptr<CFG> &cfg) {
+
+    return cfg == nullptr ? 0 : sizeof(CFG) + cfg->getAllocator().getTotalMemory();
+}
+
+} // end of anonymous namespace
+
 const std::vector<ASTFunction *> &ASTResource::getFunctions(bool use) const {
 
     if (use) {
@@ -22,15 +54,38 @@ std::vector<ASTFile *> ASTResource::getASTFiles() const {
     return ASTFiles;
 }
 
+/**
+ * the function used for a name is the first one in the order of astList, an AST indexed again
+ * keeps its place in it and a new AST comes last, so a recheck uses the functions a fresh run would.
+ * Functions of an AST indexed again are no longer in their file, they are not used.
+ */
 void ASTResource::buildUseFunctions() {
 
-    for (ASTFunction *AF : ASTFunctions) {
-        if (AF->isUse()) {
-            useASTFunctions.push_back(AF);
+    std::vector<ASTFile *> ASTFiles = getASTFiles();
+    std::sort(ASTFiles.begin(), ASTFiles.end(), [](ASTFile *a, ASTFile *b) { return a->getID() < b->getID(); });
+    for (ASTFunction *F : ASTFunctions) {
+        F->setUse(false);
+    }
+    std::unordered_set<std::string> names;
+    useASTFunctions.clear();
+    for (ASTFile *AF : ASTFiles) {
+        for (ASTFunction *F : AF->getFunctions()) {
+            F->setUse(names.insert(F->getFullName()).second);
+            if (F->isUse()) {
+                useASTFunctions.push_back(F);
+            }
         }
     }
 }
 
+void ASTResource::clearASTFile(ASTFile *AF) {
+
+    for (ASTFunction *F : AF->getFunctions()) {
+        F->setUse(false);
+    }
+    AF->clearFunctions();
+}
+
 ASTFile *ASTResource::addASTFile(std::string AST) {
 
     unsigned id = ASTs.size();
@@ -123,48 +178,235 @@ void ASTBimap::removeVariable(ASTVariable *V) {
     variableRight.erase(VD);
 }
 
-ASTManager::ASTManager(std::vector<std::string> &ASTs, ASTResource &resource, Config &configure) : resource(resource), c(configure) {
+/**
+ * index the ASTs as a pipeline: loader threads read and deserialize the ASTs while they are
+ * indexed on this thread, in the order of the list. A queue of loaders ASTs is between them.
+ */
+ASTManager::ASTManager(std::vector<std::string> &ASTs, ASTResource &resource, Config &configure) : resource(resource), c(configure), reloads(0) {
+
+    std::unordered_map<std::string, std::string> framework = configure.getOptionBlock("Framework");
+    max_size = std::stoi(framework["queue_size"]);
+    readReleaseFunctions();
+
+    // loaders = 0 reads each AST on this thread before indexing it
+    unsigned loaders = 1;
+    auto got = framework.find("loaders");
+    if (got != framework.end() && got->second != "") {
+        loaders = std::stoul(got->second);
+    }
+    auto load = [&ASTs](unsigned i) -> std::unique_ptr<ASTUnit> {
+        TRACE_SPAN(span, "loadAST", "ast", "ast", ASTs[i]);
+        Metrics::add(Metrics::AST_LOADED);
+        return ASTCache::load(ASTs[i]);
+    };
+    PipelineQueue<std::unique_ptr<ASTUnit>> loaded("loadAST", loaders);
+    std::atomic<unsigned> next(0);
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < loaders; t++) {
+        threads.push_back(std::thread([&] {
+            for (unsigned i = next++; i < ASTs.size(); i = next++) {
+                loaded.push(i, load(i));
+            }
+        }));
+    }
 
-    max_size = std::stoi(configure.getOptionBlock("Framework")["queue_size"]);
     std::unordered_set<std::string> functionNames;
-    for (std::string AST : ASTs) {
-
-        ASTFile *AF = resource.addASTFile(AST);
-        std::unique_ptr<ASTUnit> AU = common::loadFromASTFile(AST);
-        std::vector<FunctionDecl *> functions = common::getFunctions(AU->getASTContext());
+    for (unsigned i = 0; i < ASTs.size(); i++) {
+        std::unique_ptr<ASTUnit> AU = loaders == 0 ? load(i) : loaded.pop();
+        TRACE_SPAN(span, "indexAST", "ast", "ast", ASTs[i]);
+        index(resource.addASTFile(ASTs[i]), AU.get(), functionNames);
+        loadASTUnit(ASTs[i], std::move(AU));
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    if (loaders != 0) {
+        Metrics::addQueue(loaded.getStats());
+    }
+    resource.buildUseFunctions();
+}
 
-        for (FunctionDecl *FD : functions) {
-            std::string name =  common::getFullName(FD);
-            bool use = (functionNames.count(name) == 0);
-            if (use == true) {
-                functionNames.insert(name);
+/**
+ * index the functions of an AST and their variables, a function is used if its name is not in names.
+ * The names of the functions a used function calls are kept for the call graph,
+ * so it does not read the AST again.
+ */
+std::vector<ASTFunction *> ASTManager::index(ASTFile *AF, ASTUnit *AU, std::unordered_set<std::string> &names) {
+
+    std::vector<ASTFunction *> functions;
+    for (FunctionDecl *FD : common::getFunctions(AU->getASTContext())) {
+        ASTFunction *F = resource.addASTFunction(FD, AF);
+        F->setUse(names.insert(F->getFullName()).second);
+        for (VarDecl *VD : common::getVariables(FD)) {
+            resource.addASTVariable(VD, F);
+        }
+        if (F->isUse()) {
+            std::vector<std::string> &called = calls[F];
+            for (FunctionDecl *callee : common::getCalledFunctions(FD)) {
+                called.push_back(common::getFullName(callee));
             }
+        }
+        functions.push_back(F);
+    }
+    return functions;
+}
 
-            ASTFunction *F = resource.addASTFunction(FD, AF, use);
-            std::vector<VarDecl *> variables = common::getVariables(FD);
+bool ASTManager::takeCalls(ASTFunction *F, std::vector<std::string> &called) {
 
-            for (VarDecl *VD : variables) {
-                resource.addASTVariable(VD, F);
-            }
+    auto it = calls.find(F);
+    if (it == calls.end()) {
+        return false;
+    }
+    called.swap(it->second);
+    calls.erase(it);
+    return true;
+}
+
+void ASTManager::clearCalls() {
+
+    calls.clear();
+}
+
+/**
+ * a manager over an already indexed resource, ASTs are loaded on demand.
+ * Each checker worker has its own manager, as ASTUnits and CFGs are not shared between threads.
+ */
+ASTManager::ASTManager(ASTResource &resource, Config &configure, unsigned max_size) :
+    resource(resource), c(configure), max_size(max_size), reloads(0) {
+
+    readReleaseFunctions();
+}
+
+/**
+ * the ASTs and CFGs still loaded are no longer accounted, the ASTs go back to the AST cache.
+ */
+ASTManager::~ASTManager() {
+
+    for (std::unique_ptr<ASTUnit> &AU : ASTQueue) {
+        uint64_t bytes = ASTBytes[files[AU.get()]];
+        ASTCache::unload(std::move(AU), bytes);
+    }
+
+    for (auto &bytes : ASTBytes) {
+        Metrics::release(Metrics::MEMORY_AST, bytes.second);
+    }
+    for (auto &cfg : CFGs) {
+        Metrics::release(Metrics::MEMORY_CFG, getCFGBytes(cfg.second));
+    }
+}
+
+/**
+ * account the memory of a loaded AST again, it grows as its declarations are deserialized.
+ */
+void ASTManager::account(const std::string &AST, ASTUnit *AU) {
+
+    uint64_t &accounted = ASTBytes[AST];
+    uint64_t bytes = getASTBytes(AU);
+    if (bytes > accounted) {
+        Metrics::allocate(Metrics::MEMORY_AST, bytes - accounted);
+    }
+    else {
+        Metrics::release(Metrics::MEMORY_AST, accounted - bytes);
+    }
+    accounted = bytes;
+}
+
+/**
+ * read the MemoryReleaseFunction block, name = index of the released argument.
+ */
+void ASTManager::readReleaseFunctions() {
+
+    releaseKey = 0;
+    const std::map<std::string, int> &functions = c.getCheckOptions().releaseFunctions;
+    if (functions.empty()) {
+        return;
+    }
+    releaseNames.insert(functions.begin(), functions.end());
+    releaseKey = common::hashString("");
+    for (auto &content : functions) {
+        releaseKey = common::hashCombine(common::hashString(content.first, releaseKey), content.second);
+    }
+}
+
+/**
+ * find the decls of the release functions in a newly loaded AST.
+ * A function is matched by its qualified or plain name, its redeclarations share the canonical decl.
+ */
+void ASTManager::resolveReleaseFunctions(const std::string &AST, ASTUnit *AU) {
+
+    if (releaseNames.empty()) {
+        return;
+    }
+
+    // an AST of the cache already resolved for the same functions is not searched again
+    std::vector<std::pair<const FunctionDecl *, int>> &decls = releaseDeclsOf[AST];
+    if (ASTCache::getReleaseDecls(AU, releaseKey, decls)) {
+        releaseDecls.insert(decls.begin(), decls.end());
+        return;
+    }
+    for (FunctionDecl *FD : common::getFunctionDecls(AU->getASTContext())) {
+        if (!FD->getIdentifier()) {
+            continue;
+        }
+        auto it = releaseNames.find(FD->getQualifiedNameAsString());
+        // a method is only matched by its qualified name, "free" is not Pool::free
+        if (it == releaseNames.end() && !isa<CXXMethodDecl>(FD)) {
+            it = releaseNames.find(FD->getNameAsString());
+        }
+        if (it == releaseNames.end()) {
+            continue;
+        }
+        const FunctionDecl *canonical = FD->getCanonicalDecl();
+        if (releaseDecls.insert(std::make_pair(canonical, it->second)).second) {
+            decls.push_back(std::make_pair(canonical, it->second));
         }
-        loadASTUnit(std::move(AU));
     }
-    resource.buildUseFunctions();
+    ASTCache::setReleaseDecls(AU, releaseKey, decls);
+}
+
+int ASTManager::getReleaseArg(const FunctionDecl *FD) const {
+
+    auto it = releaseDecls.find(FD->getCanonicalDecl());
+    if (it == releaseDecls.end()) {
+        return -1;
+    }
+    return it->second;
+}
+
+void ASTManager::setMaxSize(unsigned size) {
+
+    max_size = size > 0 ? size : 1;
+    while (ASTQueue.size() > max_size) {
+        pop();
+    }
 }
 
-void ASTManager::loadASTUnit(std::unique_ptr<ASTUnit> AU) {
+void ASTManager::loadASTUnit(const std::string &AST, std::unique_ptr<ASTUnit> AU) {
 
     if (ASTQueue.size() == max_size) {
         pop();
     }
-    push(std::move(AU));
+    push(AST, std::move(AU));
 
 }
 
+/**
+ * read an AST file and put it in the queue.
+ */
+void ASTManager::loadAST(const std::string &AST) {
+
+    TRACE_SPAN(span, "loadAST", "ast", "ast", AST);
+    Metrics::add(Metrics::AST_LOADED);
+    if (loaded.count(AST) != 0) {
+        reloads++;
+    }
+    loadASTUnit(AST, ASTCache::load(AST));
+}
+
 ASTUnit *ASTManager::getASTUnit(ASTFile *AF) {
     auto it = ASTs.find(AF->getAST());
     if (it == ASTs.end()) {
-        loadASTUnit(common::loadFromASTFile(AF->getAST()));
+        loadAST(AF->getAST());
     }
     else {
         ASTUnit *AU = it->second;
@@ -184,12 +426,23 @@ FunctionDecl *ASTManager::getFunctionDecl(ASTFunction *F) {
         move(ASTs[F->getAST()]);
     }
     else {
-        loadASTUnit(common::loadFromASTFile(F->getAST()));
+        loadAST(F->getAST());
         FD = bimap.getFunctionDecl(F);
     }
     return FD;
 }
 
+uint64_t ASTManager::getFunctionHash(ASTFunction *F) {
+
+    uint64_t hash = F->getHash();
+    if (hash == 0) {
+        FunctionDecl *FD = getFunctionDecl(F);
+        hash = FD != nullptr ? common::getFunctionHash(FD) : 0;
+        F->setHash(hash);
+    }
+    return hash;
+}
+
 ASTVariable *ASTManager::getASTVariable(VarDecl *VD) {
 
     return bimap.getASTVariable(VD);
@@ -203,7 +456,7 @@ VarDecl *ASTManager::getVarDecl(ASTVariable *V) {
 
     VarDecl *VD = bimap.getVarDecl(V);
     if (VD == nullptr) {
-        loadASTUnit(common::loadFromASTFile(V->getAST()));
+        loadAST(V->getAST());
         VD = bimap.getVarDecl(V);
     }
     return VD;
@@ -219,12 +472,105 @@ std::unique_ptr<CFG> &ASTManager::getCFG(ASTFunction *F) {
 
     FunctionDecl *FD = getFunctionDecl(F);
 
+    TRACE_SPAN(span, "getCFG", "cfg", "function", F->getFullName());
+    Metrics::add(Metrics::CFG_BUILT);
+    MetricsPhase phase("buildCFG", true);
     std::unique_ptr<CFG> functionCFG = CFG::buildCFG(FD, FD->getBody(), &FD->getASTContext(), CFG::BuildOptions());
+    phase.end();
+    Metrics::allocate(Metrics::MEMORY_CFG, getCFGBytes(functionCFG));
+    account(F->getAST(), ASTs[F->getAST()]);
 
     return CFGs[F] = std::move(functionCFG);
 
 }
 
+std::vector<ASTFunction *> ASTManager::reloadAST(const std::string &AST) {
+
+    for (auto it = ASTQueue.begin(); it != ASTQueue.end(); it++) {
+        if (files[it->get()] == AST) {
+            evict(it);
+            break;
+        }
+    }
+
+    auto file = resource.ASTs.find(AST);
+    ASTFile *AF = file != resource.ASTs.end() ? file->second : resource.addASTFile(AST);
+    resource.clearASTFile(AF);
+
+    // a function is used if no function of an AST before it in astList has its name
+    std::unordered_set<std::string> names;
+    for (ASTFile *other : resource.getASTFiles()) {
+        if (other->getID() < AF->getID()) {
+            for (ASTFunction *F : other->getFunctions()) {
+                names.insert(F->getFullName());
+            }
+        }
+    }
+
+    TRACE_SPAN(span, "indexAST", "ast", "ast", AST);
+    std::unique_ptr<ASTUnit> AU = ASTCache::load(AST);
+    Metrics::add(Metrics::AST_LOADED);
+    if (loaded.count(AST) != 0) {
+        reloads++;
+    }
+    std::vector<ASTFunction *> functions = index(AF, AU.get(), names);
+    resource.buildUseFunctions();
+    loadASTUnit(AST, std::move(AU));
+    return functions;
+}
+
+PrefetchedAST ASTManager::prefetch(const std::string &AST, const std::vector<ASTFunction *> &functions) {
+
+    TRACE_SPAN(span, "prefetchAST", "ast", "ast", AST);
+    Metrics::add(Metrics::AST_LOADED);
+    PrefetchedAST prefetched;
+    prefetched.AST = AST;
+    prefetched.AU = ASTCache::load(AST);
+
+    // the functions of an AST are indexed in the order of its decls, as in push()
+    const std::vector<FunctionDecl *> &decls = common::getFunctions(prefetched.AU->getASTContext());
+    for (ASTFunction *F : functions) {
+        const std::vector<ASTFunction *> &ASTFunctions = F->getASTFile()->getFunctions();
+        unsigned i = std::find(ASTFunctions.begin(), ASTFunctions.end(), F) - ASTFunctions.begin();
+        if (i >= decls.size() || !decls[i]->hasBody()) {
+            continue;
+        }
+        FunctionDecl *FD = decls[i];
+        TRACE_SPAN(cfgSpan, "getCFG", "cfg", "function", F->getFullName());
+        Metrics::add(Metrics::CFG_BUILT);
+        MetricsPhase phase("buildCFG", true);
+        std::unique_ptr<CFG> functionCFG = CFG::buildCFG(FD, FD->getBody(), &FD->getASTContext(), CFG::BuildOptions());
+        phase.end();
+        prefetched.CFGs.push_back(std::make_pair(F, std::move(functionCFG)));
+    }
+    return prefetched;
+}
+
+void ASTManager::adopt(PrefetchedAST prefetched) {
+
+    if (ASTs.count(prefetched.AST) != 0) {
+        prefetched.CFGs.clear();
+        uint64_t bytes = getASTBytes(prefetched.AU.get());
+        ASTCache::unload(std::move(prefetched.AU), bytes);
+        return;
+    }
+    if (loaded.count(prefetched.AST) != 0) {
+        reloads++;
+    }
+    loadASTUnit(prefetched.AST, std::move(prefetched.AU));
+    for (auto &cfg : prefetched.CFGs) {
+        Metrics::allocate(Metrics::MEMORY_CFG, getCFGBytes(cfg.second));
+        CFGs[cfg.first] = std::move(cfg.second);
+    }
+    account(prefetched.AST, ASTs[prefetched.AST]);
+}
+
+bool ASTManager::isLoaded(const std::string &AST) const {
+
+    std::lock_guard<std::mutex> lock(residentMutex);
+    return resident.count(AST) != 0;
+}
+
 /** move ASTUnit to the end of the queue
  **/
 void ASTManager::move(ASTUnit *AU) {
@@ -252,27 +598,52 @@ void ASTManager::move(ASTUnit *AU) {
  **/
 void ASTManager::pop() {
 
-    std::string AST = ASTQueue.front()->getASTFileName();
-    for (ASTFunction *F: resource.ASTs[AST]->getFunctions()) {
+    evict(ASTQueue.begin());
+}
+
+/** remove a ASTUnit of the queue, with the decls and CFGs of its functions
+ **/
+void ASTManager::evict(std::list<std::unique_ptr<ASTUnit>>::iterator it) {
+
+    std::string AST = files[it->get()];
+    TRACE_SPAN(span, "evictAST", "ast", "ast", AST);
+    Metrics::add(Metrics::AST_EVICTED);
+    for (ASTFunction *F: resource.ASTs.at(AST)->getFunctions()) {
         for (ASTVariable *V : F->getVariables())
             bimap.removeVariable(V);
         bimap.removeFunction(F);
-        CFGs.erase(F);
+        auto it = CFGs.find(F);
+        if (it != CFGs.end()) {
+            Metrics::release(Metrics::MEMORY_CFG, getCFGBytes(it->second));
+            CFGs.erase(it);
+        }
     }
+    for (auto &decl : releaseDeclsOf[AST]) {
+        releaseDecls.erase(decl.first);
+    }
+    releaseDeclsOf.erase(AST);
 
+    Metrics::release(Metrics::MEMORY_AST, ASTBytes[AST]);
+    files.erase(it->get());
+    ASTCache::unload(std::move(*it), ASTBytes[AST]);
+    ASTBytes.erase(AST);
     ASTs.erase(AST);
-    ASTQueue.pop_front();
+    {
+        std::lock_guard<std::mutex> lock(residentMutex);
+        resident.erase(AST);
+    }
+    ASTQueue.erase(it);
 
-    common::printLog("pop" + AST + "\n", common::CheckerName::taintChecker, 1, c);
+    CHECKER_LOG(common::CheckerName::taintChecker, 1, c, "pop" + AST + "\n");
 
 }
 
-void ASTManager::push(std::unique_ptr<ASTUnit> AU) {
+void ASTManager::push(const std::string &AST, std::unique_ptr<ASTUnit> AU) {
 
-    std::string AST = AU->getASTFileName();
 
     const std::vector<FunctionDecl *> &functions = common::getFunctions(AU->getASTContext());
-    const std::vector<ASTFunction *> &ASTFunctions = resource.ASTs[AST]->getFunctions();
+    // the resource is shared by the managers of all workers, so it is only read here.
+    const std::vector<ASTFunction *> &ASTFunctions = resource.ASTs.at(AST)->getFunctions();
 
     for (unsigned i = 0; i < functions.size(); i++) {
         FunctionDecl *FD = functions[i];
@@ -287,10 +658,19 @@ void ASTManager::push(std::unique_ptr<ASTUnit> AU) {
         }
     }
 
+    resolveReleaseFunctions(AST, AU.get());
+
     ASTs[AST] = AU.get();
+    {
+        std::lock_guard<std::mutex> lock(residentMutex);
+        resident.insert(AST);
+    }
+    files[AU.get()] = AST;
+    loaded.insert(AST);
+    account(AST, AU.get());
     ASTQueue.push_back(std::move(AU));
 
-    common::printLog("push" + AST + "\n", common::CheckerName::taintChecker, 1, c);
+    CHECKER_LOG(common::CheckerName::taintChecker, 1, c, "push" + AST + "\n");
 
 }
 
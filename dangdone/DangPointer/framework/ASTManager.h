@@ -5,9 +5,12 @@
 #include "ASTElement.h"
 
 #include "Config.h"
+#include "CountingAllocator.h"
 
 #include <list>
+#include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 
 #include <clang/Analysis/CFG.h>
 #include <clang/Frontend/ASTUnit.h>
@@ -40,11 +43,19 @@ private:
 
 	void buildUseFunctions();
 
+    void clearASTFile(ASTFile *AF);
     ASTFile *addASTFile(std::string AST);
     ASTFunction *addASTFunction(FunctionDecl *FD, ASTFile *AF, bool use=true);
     ASTVariable *addASTVariable(VarDecl *VD, ASTFunction *F);
 };
 
+/**
+ * an unordered_map whose memory is accounted to the bimap.
+ */
+template <typename K, typename V>
+using BimapMap = std::unordered_map<K, V, std::hash<K>, std::equal_to<K>,
+    CountingAllocator<std::pair<const K, V>, Metrics::MEMORY_BIMAP>>;
+
 /**
  * a bidirectional map.
  * You can get a pointer from an id or get an id from a pointer.
@@ -69,13 +80,26 @@ private:
     void removeVariable(ASTVariable *V);
 
 
-    std::unordered_map<ASTFunction *, FunctionDecl *> functionMap;
+    BimapMap<ASTFunction *, FunctionDecl *> functionMap;
 
-    std::unordered_map<ASTVariable *, VarDecl *> variableLeft;
-    std::unordered_map<VarDecl *, ASTVariable *> variableRight;
+    BimapMap<ASTVariable *, VarDecl *> variableLeft;
+    BimapMap<VarDecl *, ASTVariable *> variableRight;
 
 };
 
+/**
+ * an AST read ahead of the manager that will use it, with the CFGs of some of its functions,
+ * built while no manager owns it.
+ */
+class PrefetchedAST {
+
+public:
+
+    std::string AST;
+    std::unique_ptr<ASTUnit> AU;
+    std::vector<std::pair<ASTFunction *, std::unique_ptr<CFG>>> CFGs;
+};
+
 /**
  * a class that manages all ASTs.
  */
@@ -84,15 +108,71 @@ class ASTManager {
 public:
     
     ASTManager(std::vector<std::string> &ASTs, ASTResource &resource, Config &configure);
+    ASTManager(ASTResource &resource, Config &configure, unsigned max_size);
+    ~ASTManager();
 
     ASTUnit *getASTUnit(ASTFile *AF);
     FunctionDecl *getFunctionDecl(ASTFunction *F);
 
+    /**
+     * the hash of F (ASTFunction::getHash), computed from its decl the first time it is needed.
+     * Hashing reads the whole body, so it is not done when an AST is indexed.
+     */
+    uint64_t getFunctionHash(ASTFunction *F);
+
     ASTVariable *getASTVariable(VarDecl *VD);
     VarDecl *getVarDecl(ASTVariable *V);
     
     std::unique_ptr<CFG> &getCFG(ASTFunction *F);
 
+    /**
+     * index an AST file again after it changed, or index a new AST file.
+     * The functions it had are no longer used, they keep their ids. Return the functions indexed.
+     */
+    std::vector<ASTFunction *> reloadAST(const std::string &AST);
+
+    /**
+     * read AST and build the CFGs of those of functions with a body. It uses no manager,
+     * so it may run on any thread.
+     */
+    static PrefetchedAST prefetch(const std::string &AST, const std::vector<ASTFunction *> &functions);
+
+    /**
+     * take an AST of prefetch() with its CFGs. If this manager has loaded the AST since,
+     * the prefetched one goes back to the AST cache.
+     */
+    void adopt(PrefetchedAST prefetched);
+
+    /**
+     * whether AST is loaded, it may be called while another thread uses the manager.
+     */
+    bool isLoaded(const std::string &AST) const;
+
+    /**
+     * move the names of the functions F calls, extracted when its AST was indexed, to called.
+     * false if they were not extracted, the AST is then read for them.
+     */
+    bool takeCalls(ASTFunction *F, std::vector<std::string> &called);
+    void clearCalls();
+
+    /**
+     * the argument released by FD if it is a function of the MemoryReleaseFunction block, -1 otherwise.
+     * Release functions are resolved to their decls when an AST is loaded, so this is a pointer lookup.
+     */
+    int getReleaseArg(const FunctionDecl *FD) const;
+
+    unsigned getMaxSize() const {
+        return max_size;
+    }
+
+    /**
+     * number of ASTs loaded again after being evicted.
+     */
+    unsigned getReloads() const {
+        return reloads;
+    }
+    void setMaxSize(unsigned size);
+
 private:
     
     ASTResource &resource;
@@ -104,12 +184,39 @@ private:
 
     unsigned max_size;
     std::list<std::unique_ptr<ASTUnit>> ASTQueue;
+    // the AST file of each ASTUnit loaded, an ASTUnit of the AST cache may have been read from another path
+    std::unordered_map<const ASTUnit *, std::string> files;
+    unsigned reloads;
+    // the ASTs this manager has loaded, a load of one of them is a reload
+    std::unordered_set<std::string> loaded;
+    // bytes of each loaded AST accounted to Metrics::MEMORY_AST
+    std::unordered_map<std::string, uint64_t> ASTBytes;
+    // names of the functions called by the functions indexed, until the call graph takes them
+    std::unordered_map<ASTFunction *, std::vector<std::string>> calls;
+    // the keys of ASTs, for isLoaded on other threads
+    mutable std::mutex residentMutex;
+    std::unordered_set<std::string> resident;
+
+    // configured release functions by name, and their canonical decls in the loaded ASTs
+    std::unordered_map<std::string, int> releaseNames;
+    // hash of releaseNames, the AST cache keeps the decls resolved for it
+    uint64_t releaseKey;
+    std::unordered_map<const FunctionDecl *, int> releaseDecls;
+    std::unordered_map<std::string, std::vector<std::pair<const FunctionDecl *, int>>> releaseDeclsOf;
+
+    void readReleaseFunctions();
+    void resolveReleaseFunctions(const std::string &AST, ASTUnit *AU);
 
     void pop();
+    void evict(std::list<std::unique_ptr<ASTUnit>>::iterator it);
     void move(ASTUnit *AU);
-    void push(std::unique_ptr<ASTUnit> AU);
+    void push(const std::string &AST, std::unique_ptr<ASTUnit> AU);
     
-    void loadASTUnit(std::unique_ptr<ASTUnit> AU);
+    void account(const std::string &AST, ASTUnit *AU);
+    std::vector<ASTFunction *> index(ASTFile *AF, ASTUnit *AU, std::unordered_set<std::string> &names);
+
+    void loadASTUnit(const std::string &AST, std::unique_ptr<ASTUnit> AU);
+    void loadAST(const std::string &AST);
 
 };
 
@@ -1,11 +1,6 @@
 
 #include "BasicChecker.h"
 
-ASTResource* BasicChecker::resource = nullptr;
-ASTManager* BasicChecker::manager = nullptr;
-CallGraph* BasicChecker::call_graph = nullptr;
-Config* BasicChecker::configure = nullptr;
-
 BasicChecker::BasicChecker(ASTResource *resource, ASTManager *manager, CallGraph *call_graph, Config *configure) {
     
     this->resource = resource;
@@ -17,7 +12,7 @@ BasicChecker::BasicChecker(ASTResource *resource, ASTManager *manager, CallGraph
 void BasicChecker::check() {
 
     for (auto F : resource->getFunctions()) {
-        auto & it = BasicChecker::manager->getCFG(F);
+        auto & it = manager->getCFG(F);
         for (CFGBlock *block : *it) {
             std::cout << block->getBlockID() << std::endl;
             block->dump();
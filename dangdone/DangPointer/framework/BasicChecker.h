@@ -6,17 +6,52 @@
 #include "Config.h"
 #include "CallGraph.h"
 
+class CFGVisitor;
+class LazyFunction;
+
+/**
+ * base of checkers.
+ * The context is per instance, so checkers can run in parallel, each with its own ASTManager.
+ */
 class BasicChecker {
     
 public:
-    static ASTResource *resource;
-    static ASTManager *manager;
-    static CallGraph *call_graph;
-    static Config *configure;
+    ASTResource *resource;
+    ASTManager *manager;
+    CallGraph *call_graph;
+    Config *configure;
 
     BasicChecker(ASTResource *resource, ASTManager *manager, CallGraph *call_graph, Config *configure);
+    virtual ~BasicChecker() {}
 
     void check();
+
+    /**
+     * the part of the checker in a run of CheckDriver, which visits the functions.
+     * beginCheck prepares a run and returns the first wavefront of the call graph the checker
+     * visits, 0 unless it resumes a run. fork makes the checker of another worker, with its own
+     * manager, once beginCheck is done. endWavefront is called once the functions of a wavefront
+     * are visited and endCheck at the end of the run, on the checker added to the driver only.
+     */
+    virtual unsigned beginCheck() {
+        return 0;
+    }
+    virtual BasicChecker *fork(ASTManager *manager) = 0;
+    virtual void endWavefront(unsigned wavefront) {}
+    virtual void endCheck() {}
+
+    /**
+     * the part of the checker in the CFGVisitor walk of a function.
+     * subscribe registers the callbacks once. beginFunction is called before the CFG of the
+     * function is built, it takes the decl and the CFG from function if it needs them, and returns
+     * false if it does not walk the function. The callbacks run between beginFunction and
+     * endFunction; a function whose CFG cannot be built is not walked.
+     */
+    virtual void subscribe(CFGVisitor &visitor) {}
+    virtual bool beginFunction(ASTFunction *F, LazyFunction &function) {
+        return false;
+    }
+    virtual void endFunction(ASTFunction *F, FunctionDecl *FD, const CFG &cfg) {}
 };
 
 
@@ -0,0 +1,96 @@
+#ifndef BINARY_IO_H
+#define BINARY_IO_H
+
+#include <string>
+
+#include <stdint.h>
+
+/**
+ * little-endian encoding of the binary files of a run (checkpoint, spill store),
+ * so they do not depend on the host.
+ */
+class BinaryWriter {
+
+public:
+
+    void put32(uint32_t value) {
+        for (int i = 0; i < 4; i++) {
+            data.push_back((char)(value >> (i * 8)));
+        }
+    }
+
+    void put64(uint64_t value) {
+        for (int i = 0; i < 8; i++) {
+            data.push_back((char)(value >> (i * 8)));
+        }
+    }
+
+    void putString(const std::string &s) {
+        put32(s.size());
+        data += s;
+    }
+
+    std::string data;
+};
+
+/**
+ * reads what BinaryWriter wrote from data[pos, end), isOk() is false once a read goes past the end.
+ */
+class BinaryReader {
+
+public:
+
+    BinaryReader(const std::string &data, size_t pos, size_t end) : data(data), pos(pos), end(end), ok(true) {}
+
+    uint32_t get32() {
+        uint32_t value = 0;
+        if (!take(4)) {
+            return 0;
+        }
+        for (int i = 0; i < 4; i++) {
+            value |= (uint32_t)(unsigned char)data[pos - 4 + i] << (i * 8);
+        }
+        return value;
+    }
+
+    uint64_t get64() {
+        uint64_t value = 0;
+        if (!take(8)) {
+            return 0;
+        }
+        for (int i = 0; i < 8; i++) {
+            value |= (uint64_t)(unsigned char)data[pos - 8 + i] << (i * 8);
+        }
+        return value;
+    }
+
+    std::string getString() {
+        uint32_t size = get32();
+        if (!take(size)) {
+            return "";
+        }
+        return data.substr(pos - size, size);
+    }
+
+    bool isOk() const {
+        return ok;
+    }
+
+private:
+
+    const std::string &data;
+    size_t pos;
+    size_t end;
+    bool ok;
+
+    bool take(size_t size) {
+        if (!ok || end - pos < size) {
+            ok = false;
+            return false;
+        }
+        pos += size;
+        return true;
+    }
+};
+
+#endif
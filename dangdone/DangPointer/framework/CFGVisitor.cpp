@@ -0,0 +1,68 @@
+#include "CFGVisitor.h"
+#include "Tracer.h"
+
+CFGVisitor::CFGVisitor() {
+}
+
+void CFGVisitor::addChecker(BasicChecker *checker) {
+
+    checkers.push_back(checker);
+    enabled.push_back(true);
+    active.push_back(false);
+    checker->subscribe(*this);
+}
+
+void CFGVisitor::setEnabled(unsigned checker, bool enabled) {
+
+    this->enabled[checker] = enabled;
+}
+
+unsigned CFGVisitor::find(BasicChecker *checker) const {
+
+    for (unsigned i = 0; i < checkers.size(); i++) {
+        if (checkers[i] == checker) {
+            return i;
+        }
+    }
+    return checkers.size();
+}
+
+void CFGVisitor::visit(ASTFunction *F, LazyFunction &function) {
+
+    bool any = false;
+    for (unsigned i = 0; i < checkers.size(); i++) {
+        active[i] = enabled[i] && checkers[i]->beginFunction(F, function);
+        any = any || active[i];
+    }
+    if (!any) {
+        return;
+    }
+    const CFG *cfg = function.getCFG();
+    if (cfg == nullptr) {
+        return;
+    }
+
+    TRACE_SPAN(span, "visit", "checker", "function", F->getFullName());
+    for (const CFGBlock *block : *cfg) {
+        unsigned index = 0;
+        for (CFGBlock::const_iterator it = block->begin(); it != block->end(); ++it, ++index) {
+            Optional<CFGStmt> element = it->getAs<CFGStmt>();
+            if (!element) {
+                continue;
+            }
+            const Stmt *S = element->getStmt();
+            for (const Subscriber &subscriber : table[S->getStmtClass()]) {
+                if (active[subscriber.checker]) {
+                    subscriber.dispatch(checkers[subscriber.checker], S, block, index);
+                }
+            }
+        }
+    }
+
+    FunctionDecl *FD = function.getDecl();
+    for (unsigned i = 0; i < checkers.size(); i++) {
+        if (active[i]) {
+            checkers[i]->endFunction(F, FD, *cfg);
+        }
+    }
+}
@@ -0,0 +1,127 @@
+#ifndef CFG_VISITOR_H
+#define CFG_VISITOR_H
+
+#include <vector>
+
+#include <clang/AST/AST.h>
+#include <clang/Analysis/CFG.h>
+
+#include "BasicChecker.h"
+
+using namespace clang;
+
+/**
+ * the StmtClass of each concrete statement class, generated from StmtNodes.inc.
+ * Abstract classes have no StmtClass, subscribing to them does not compile.
+ */
+template<class Node> class StmtClassOf;
+
+#define ABSTRACT_STMT(STMT)
+#define STMT(CLASS, PARENT) \
+    template<> class StmtClassOf<CLASS> { \
+    public: \
+        static const Stmt::StmtClass value = Stmt::CLASS##Class; \
+    };
+#include "clang/AST/StmtNodes.inc"
+
+/**
+ * the decl and the CFG of the function being visited, loaded by the first checker asking for them:
+ * a function no checker walks, e.g. whose result is cached, does not load its AST or build its CFG.
+ */
+class LazyFunction {
+
+public:
+
+    LazyFunction(ASTManager &manager, ASTFunction *F) : manager(manager), F(F), FD(nullptr), cfg(nullptr), built(false) {}
+
+    FunctionDecl *getDecl() {
+        if (FD == nullptr) {
+            FD = manager.getFunctionDecl(F);
+        }
+        return FD;
+    }
+
+    /**
+     * the CFG, nullptr if it cannot be built.
+     */
+    const CFG *getCFG() {
+        if (!built) {
+            cfg = manager.getCFG(F).get();
+            built = true;
+        }
+        return cfg;
+    }
+
+private:
+
+    ASTManager &manager;
+    ASTFunction *F;
+    FunctionDecl *FD;
+    const CFG *cfg;
+    bool built;
+};
+
+/**
+ * one walk of the CFG of a function for all checkers.
+ * A checker subscribes a callback to each statement class it handles; the walk dispatches
+ * a statement through a table indexed by its StmtClass, to the subscribed checkers only.
+ */
+class CFGVisitor {
+
+public:
+
+    CFGVisitor();
+
+    /**
+     * add a checker, which subscribes its callbacks in BasicChecker::subscribe.
+     */
+    void addChecker(BasicChecker *checker);
+
+    /**
+     * a disabled checker is not called for the functions visited, e.g. the functions of a
+     * resumed run before its checkpoint. checker is the index of the checker in the order added.
+     */
+    void setEnabled(unsigned checker, bool enabled);
+
+    /**
+     * call Visit(S, block, index) on checker for the statements of class Node,
+     * index being the position of S in block.
+     */
+    template<class Node, class Checker, void (Checker::*Visit)(const Node *, const CFGBlock *, unsigned)>
+    void subscribe(Checker *checker) {
+        table[StmtClassOf<Node>::value].push_back(Subscriber(find(checker), &dispatch<Node, Checker, Visit>));
+    }
+
+    /**
+     * walk the CFG of F once, for the checkers whose beginFunction returns true.
+     */
+    void visit(ASTFunction *F, LazyFunction &function);
+
+private:
+
+    typedef void (*Dispatch)(BasicChecker *checker, const Stmt *S, const CFGBlock *block, unsigned index);
+
+    template<class Node, class Checker, void (Checker::*Visit)(const Node *, const CFGBlock *, unsigned)>
+    static void dispatch(BasicChecker *checker, const Stmt *S, const CFGBlock *block, unsigned index) {
+        (static_cast<Checker *>(checker)->*Visit)(static_cast<const Node *>(S), block, index);
+    }
+
+    class Subscriber {
+    public:
+        Subscriber(unsigned checker, Dispatch dispatch) : checker(checker), dispatch(dispatch) {}
+        // index in checkers
+        unsigned checker;
+        Dispatch dispatch;
+    };
+
+    std::vector<BasicChecker *> checkers;
+    std::vector<bool> enabled;
+    // checkers visiting the current function
+    std::vector<bool> active;
+    std::vector<Subscriber> table[Stmt::lastStmtConstant + 1];
+
+    unsigned find(BasicChecker *checker) const;
+
+};
+
+#endif
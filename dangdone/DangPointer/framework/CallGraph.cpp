@@ -1,11 +1,61 @@
 
 #include <iostream>
+#include <algorithm>
+#include <set>
+#include <unordered_set>
 #include "CallGraph.h"
 
 using namespace std;
 
 CallGraph::CallGraph(ASTManager &manager, const ASTResource &resource) {
-    
+
+    update(manager, resource);
+}
+
+void CallGraph::update(ASTManager &manager, const ASTResource &resource) {
+
+    std::unordered_set<std::string> used;
+    for (ASTFunction *F : resource.getFunctions()) {
+        used.insert(F->getFullName());
+        auto &called = calls[F->getFullName()];
+        if (called.first == F) {
+            continue;
+        }
+        called.first = F;
+        called.second.clear();
+        if (manager.takeCalls(F, called.second)) {
+            continue;
+        }
+        FunctionDecl *FD = manager.getFunctionDecl(F);
+        for (FunctionDecl *called_func : common::getCalledFunctions(FD)) {
+            called.second.push_back(common::getFullName(called_func));
+        }
+    }
+    manager.clearCalls();
+    for (auto it = calls.begin(); it != calls.end(); ) {
+        if (used.count(it->first) == 0) {
+            it = calls.erase(it);
+        }
+        else {
+            it++;
+        }
+    }
+    link(resource);
+}
+
+/**
+ * build the nodes and edges from the calls, then the SCCs and wavefronts.
+ */
+void CallGraph::link(const ASTResource &resource) {
+
+    for (auto &content : nodes) {
+        delete content.second;
+    }
+    nodes.clear();
+    topLevelFunctions.clear();
+    SCCs.clear();
+    wavefronts.clear();
+
     for (ASTFunction *F : resource.getFunctions()) {
         CallGraphNode *node = new CallGraphNode(F);
         nodes.insert(std::make_pair(F->getFullName(), node));
@@ -13,11 +63,7 @@ CallGraph::CallGraph(ASTManager &manager, const ASTResource &resource) {
     
     for (auto &content : nodes) {
         CallGraphNode *node = content.second;
-        FunctionDecl *FD = manager.getFunctionDecl(node->getFunction());
-        auto v = common::getCalledFunctions(FD);
-
-        for (FunctionDecl *called_func : v) {
-            string name = common::getFullName(called_func);
+        for (const string &name : calls[content.first].second) {
 			auto it = nodes.find(name);
 			
             if (it != nodes.end()) {
@@ -27,12 +73,116 @@ CallGraph::CallGraph(ASTManager &manager, const ASTResource &resource) {
         }
     }
     
+    // children are kept in function id order, so the SCCs do not depend on pointer values.
+    auto byID = [](ASTFunction *a, ASTFunction *b) { return a->getID() < b->getID(); };
+    for (auto &content : nodes) {
+        CallGraphNode *node = content.second;
+        std::sort(node->children.begin(), node->children.end(), byID);
+        node->children.erase(std::unique(node->children.begin(), node->children.end()), node->children.end());
+        std::sort(node->parents.begin(), node->parents.end(), byID);
+        node->parents.erase(std::unique(node->parents.begin(), node->parents.end()), node->parents.end());
+    }
+    
     for (ASTFunction *F : resource.getFunctions()) {
         if (nodes[F->getFullName()]->getParents().size() == 0) {
             topLevelFunctions.push_back(F);
         }
     }
 
+    buildSCCs(resource);
+}
+
+/**
+ * Tarjan's algorithm with an explicit stack, deep call chains would overflow a recursive one.
+ * Tarjan emits an SCC after all SCCs it reaches, so SCCs come out callees first.
+ */
+void CallGraph::buildSCCs(const ASTResource &resource) {
+
+    const unsigned UNVISITED = ~0u;
+    unsigned size = resource.getFunctions(false).size();
+    std::vector<unsigned> index(size, UNVISITED);
+    std::vector<unsigned> lowlink(size, 0);
+    std::vector<unsigned> SCCOf(size, UNVISITED);
+    std::vector<bool> onStack(size, false);
+
+    std::vector<ASTFunction *> stack;
+    // the functions being visited and the next child to visit of each
+    std::vector<std::pair<ASTFunction *, unsigned>> visiting;
+    unsigned next = 0;
+
+    for (ASTFunction *root : resource.getFunctions()) {
+        if (index[root->getID()] != UNVISITED) {
+            continue;
+        }
+
+        index[root->getID()] = lowlink[root->getID()] = next++;
+        stack.push_back(root);
+        onStack[root->getID()] = true;
+        visiting.push_back(std::make_pair(root, 0));
+
+        while (!visiting.empty()) {
+            ASTFunction *F = visiting.back().first;
+            unsigned id = F->getID();
+            const std::vector<ASTFunction *> &children = getChildren(F);
+
+            if (visiting.back().second < children.size()) {
+                ASTFunction *child = children[visiting.back().second++];
+                unsigned childID = child->getID();
+                if (index[childID] == UNVISITED) {
+                    index[childID] = lowlink[childID] = next++;
+                    stack.push_back(child);
+                    onStack[childID] = true;
+                    visiting.push_back(std::make_pair(child, 0));
+                }
+                else if (onStack[childID]) {
+                    lowlink[id] = std::min(lowlink[id], index[childID]);
+                }
+                continue;
+            }
+
+            visiting.pop_back();
+            if (!visiting.empty()) {
+                unsigned parentID = visiting.back().first->getID();
+                lowlink[parentID] = std::min(lowlink[parentID], lowlink[id]);
+            }
+
+            if (lowlink[id] == index[id]) {
+                CallGraphSCC SCC(SCCs.size());
+                ASTFunction *member;
+                do {
+                    member = stack.back();
+                    stack.pop_back();
+                    onStack[member->getID()] = false;
+                    SCCOf[member->getID()] = SCC.id;
+                    SCC.functions.push_back(member);
+                } while (member != F);
+                std::reverse(SCC.functions.begin(), SCC.functions.end());
+                SCCs.push_back(SCC);
+            }
+        }
+    }
+
+    // callees of an SCC come before it, so their levels are already known.
+    for (CallGraphSCC &SCC : SCCs) {
+        std::set<unsigned> callees;
+        for (ASTFunction *F : SCC.functions) {
+            for (ASTFunction *child : getChildren(F)) {
+                unsigned callee = SCCOf[child->getID()];
+                if (callee != SCC.id) {
+                    callees.insert(callee);
+                }
+            }
+        }
+        SCC.callees.assign(callees.begin(), callees.end());
+        for (unsigned callee : SCC.callees) {
+            SCC.level = std::max(SCC.level, SCCs[callee].level + 1);
+        }
+
+        if (wavefronts.size() <= SCC.level) {
+            wavefronts.resize(SCC.level + 1);
+        }
+        wavefronts[SCC.level].push_back(SCC.id);
+    }
 }
 
 CallGraph::~CallGraph() {
@@ -64,6 +214,14 @@ const std::vector<ASTFunction *> &CallGraph::getChildren(ASTFunction *F) const {
     return it->second->getChildren();
 }
 
+const std::vector<CallGraphSCC> &CallGraph::getSCCs() const {
+    return SCCs;
+}
+
+const std::vector<std::vector<unsigned>> &CallGraph::getWavefronts() const {
+    return wavefronts;
+}
+
 CallGraphNode* CallGraph::getNode(ASTFunction* f) {
 
 	if(f == nullptr){
@@ -6,6 +6,48 @@
 
 #include "ASTManager.h"
 
+/**
+ * a strongly connected component of the call graph.
+ * Functions calling each other recursively are in the same SCC.
+ */
+class CallGraphSCC {
+
+public:
+
+    CallGraphSCC(unsigned id) : id(id), level(0) {}
+
+    unsigned getID() const {
+        return id;
+    }
+
+    /**
+     * the wavefront of the SCC: 0 if it calls no other SCC,
+     * otherwise one more than the highest level of the SCCs it calls.
+     */
+    unsigned getLevel() const {
+        return level;
+    }
+
+    const std::vector<ASTFunction *> &getFunctions() const {
+        return functions;
+    }
+
+    const std::vector<unsigned> &getCallees() const {
+        return callees;
+    }
+
+private:
+
+    friend class CallGraph;
+
+    unsigned id;
+    unsigned level;
+
+    std::vector<ASTFunction *> functions;
+    std::vector<unsigned> callees;
+
+};
+
 class CallGraphNode {
 
 public:
@@ -37,6 +79,7 @@ public:
 private:
 	 
 	friend class NonRecursiveCallGraph;
+	friend class CallGraph;
 	 
     ASTFunction *F;
 
@@ -54,6 +97,13 @@ public:
     CallGraph(ASTManager &manager, const ASTResource &resource);
     ~CallGraph();
 
+    /**
+     * link the graph again after ASTs were indexed again.
+     * Only the functions used since the last link have their calls read, from the names
+     * extracted when their AST was indexed, or from their ASTs.
+     */
+    void update(ASTManager &manager, const ASTResource &resource);
+
     const std::vector<ASTFunction *> &getTopLevelFunctions() const;
 
     ASTFunction *getFunction(FunctionDecl *FD) const;
@@ -61,11 +111,31 @@ public:
     const std::vector<ASTFunction *> &getParents(ASTFunction *F) const;
     const std::vector<ASTFunction *> &getChildren(ASTFunction *F) const;
 
+    /**
+     * SCCs of the call graph, callees before callers.
+     */
+    const std::vector<CallGraphSCC> &getSCCs() const;
+
+    /**
+     * ids of the SCCs of each level.
+     * SCCs of the same level do not call each other, so they can be analyzed in parallel
+     * once all lower levels are done.
+     */
+    const std::vector<std::vector<unsigned>> &getWavefronts() const;
+
 protected:
     std::unordered_map<std::string, CallGraphNode *> nodes;
+    // the function used for a name and the names of the functions it calls
+    std::unordered_map<std::string, std::pair<ASTFunction *, std::vector<std::string>>> calls;
     std::vector<ASTFunction *> topLevelFunctions;
 	CallGraphNode* getNode(ASTFunction* f);
 
+    std::vector<CallGraphSCC> SCCs;
+    std::vector<std::vector<unsigned>> wavefronts;
+
+    void link(const ASTResource &resource);
+    void buildSCCs(const ASTResource &resource);
+
 };
 
 #endif
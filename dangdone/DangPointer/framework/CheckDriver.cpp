@@ -0,0 +1,146 @@
+#include "CheckDriver.h"
+#include "Tracer.h"
+#include "Logger.h"
+
+#include <map>
+#include <thread>
+#include <algorithm>
+
+CheckDriver::CheckDriver(ASTResource &resource, ASTManager &manager, CallGraph &callGraph, Config &configure, ThreadPool *pool) :
+    resource(resource), manager(manager), callGraph(callGraph), configure(configure), pool(pool), mainWorker(&manager) {
+}
+
+void CheckDriver::addChecker(BasicChecker *checker) {
+
+    checkers.push_back(checker);
+    mainWorker.visitor.addChecker(checker);
+}
+
+void CheckDriver::visit(Worker &worker, ASTFunction *F) {
+
+    TRACE_SPAN(span, "analyzeFunction", "checker", "function", F->getFullName());
+    LazyFunction function(*worker.manager, F);
+    worker.visitor.visit(F, function);
+}
+
+/**
+ * push the SCCs of the wavefronts from start in the order the workers take them. An AST is only
+ * read if no worker has it, a worker that has not loaded it yet when it takes the SCC reads it itself.
+ */
+void CheckDriver::prefetch(const std::vector<Worker *> &workers, unsigned start, PipelineQueue<PrefetchedSCC> &queue) {
+
+    Logger::setThreadTag("prefetch");
+    const std::vector<CallGraphSCC> &SCCs = callGraph.getSCCs();
+    const std::vector<std::vector<unsigned>> &wavefronts = callGraph.getWavefronts();
+    unsigned sequence = 0;
+    for (unsigned w = start; w < wavefronts.size(); w++) {
+        for (unsigned SCC : wavefronts[w]) {
+            std::map<std::string, std::vector<ASTFunction *>> functions;
+            for (ASTFunction *F : SCCs[SCC].getFunctions()) {
+                functions[F->getAST()].push_back(F);
+            }
+            PrefetchedSCC prefetched;
+            prefetched.SCC = SCC;
+            for (auto &AST : functions) {
+                bool loaded = false;
+                for (Worker *worker : workers) {
+                    loaded = loaded || worker->manager->isLoaded(AST.first);
+                }
+                if (!loaded) {
+                    prefetched.ASTs.push_back(ASTManager::prefetch(AST.first, AST.second));
+                }
+            }
+            queue.push(sequence++, std::move(prefetched));
+        }
+    }
+}
+
+void CheckDriver::run() {
+
+    if (checkers.empty()) {
+        return;
+    }
+    // the own pool is started by the first run, so its workers are counted in the phase of the run.
+    // threads = 0 means one thread per core.
+    if (pool == nullptr) {
+        unsigned threads = configure.getCheckOptions().threads;
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        ownPool.reset(new ThreadPool(threads));
+        pool = ownPool.get();
+    }
+    // a checker resuming a run starts at a later wavefront
+    std::vector<unsigned> firstWavefronts;
+    unsigned start = ~0u;
+    for (BasicChecker *checker : checkers) {
+        firstWavefronts.push_back(checker->beginCheck());
+        start = std::min(start, firstWavefronts.back());
+    }
+
+    // the queue is split between the workers, so they keep queue_size ASTs in memory all together.
+    // A shared pool has the size of the first run of the batch, not threads.
+    unsigned queueSize = manager.getMaxSize();
+    unsigned share = std::max(1u, queueSize / pool->size());
+    manager.setMaxSize(share);
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<Worker *> all(1, &mainWorker);
+    for (unsigned i = 1; i < pool->size(); i++) {
+        ASTManager *workerManager = new ASTManager(resource, configure, share);
+        workers.push_back(std::unique_ptr<Worker>(new Worker(workerManager)));
+        workers.back()->ownManager.reset(workerManager);
+        for (BasicChecker *checker : checkers) {
+            workers.back()->forks.push_back(std::unique_ptr<BasicChecker>(checker->fork(workerManager)));
+            workers.back()->visitor.addChecker(workers.back()->forks.back().get());
+        }
+        all.push_back(workers.back().get());
+    }
+
+    // the prefetch thread runs ahead across wavefronts: reading an AST or building a CFG does not
+    // need the summaries of the wavefront before. prefetch SCCs per worker are prepared at most.
+    unsigned depth = configure.getCheckOptions().prefetch * pool->size();
+    PipelineQueue<PrefetchedSCC> prefetched("prefetchCFG", depth);
+    std::thread prefetcher;
+    if (depth != 0) {
+        prefetcher = std::thread(&CheckDriver::prefetch, this, std::cref(all), start, std::ref(prefetched));
+    }
+
+    const std::vector<CallGraphSCC> &SCCs = callGraph.getSCCs();
+    const std::vector<std::vector<unsigned>> &wavefronts = callGraph.getWavefronts();
+    for (unsigned w = start; w < wavefronts.size(); w++) {
+        const std::vector<unsigned> &wavefront = wavefronts[w];
+        TRACE_SPAN(span, "wavefront", "checker", "wavefront", std::to_string(w));
+        for (Worker *worker : all) {
+            for (unsigned i = 0; i < checkers.size(); i++) {
+                worker->visitor.setEnabled(i, w >= firstWavefronts[i]);
+            }
+        }
+        pool->run(wavefront.size(), [&](unsigned worker, unsigned i) {
+            unsigned SCC = wavefront[i];
+            if (depth != 0) {
+                PrefetchedSCC next = prefetched.pop();
+                for (PrefetchedAST &AST : next.ASTs) {
+                    all[worker]->manager->adopt(std::move(AST));
+                }
+                SCC = next.SCC;
+            }
+            for (ASTFunction *F : SCCs[SCC].getFunctions()) {
+                visit(*all[worker], F);
+            }
+        });
+        for (unsigned i = 0; i < checkers.size(); i++) {
+            if (w >= firstWavefronts[i]) {
+                checkers[i]->endWavefront(w);
+            }
+        }
+    }
+    if (depth != 0) {
+        prefetcher.join();
+        Metrics::addQueue(prefetched.getStats());
+    }
+    manager.setMaxSize(queueSize);
+
+    for (BasicChecker *checker : checkers) {
+        checker->endCheck();
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef CHECK_DRIVER_H
+#define CHECK_DRIVER_H
+
+#include <vector>
+#include <memory>
+
+#include "BasicChecker.h"
+#include "CFGVisitor.h"
+#include "ThreadPool.h"
+#include "PipelineQueue.h"
+
+/**
+ * runs the checkers over the functions of a program, callees before callers, and owns the walk.
+ * The SCCs of a wavefront of the call graph only call SCCs of lower wavefronts, they are visited in
+ * parallel on the workers of a thread pool, the functions of an SCC one after another.
+ * Worker 0 is the calling thread, with the manager and the checkers added to the driver; each other
+ * worker has its own ASTManager and a fork of each checker, as ASTUnits and CFGs are not shared
+ * between threads. A worker walks the CFG of a function once for all its checkers.
+ * A prefetch thread reads ahead the ASTs of the next SCCs and builds their CFGs, the workers
+ * take the SCCs from it through a bounded queue.
+ */
+class CheckDriver {
+
+public:
+
+    /**
+     * pool is shared by the runs of a batch, nullptr for a pool of the threads of the Framework block,
+     * started by the first run.
+     */
+    CheckDriver(ASTResource &resource, ASTManager &manager, CallGraph &callGraph, Config &configure, ThreadPool *pool);
+
+    void addChecker(BasicChecker *checker);
+
+    /**
+     * one run of the checkers over the program, a daemon runs them again after each change.
+     */
+    void run();
+
+private:
+
+    class Worker {
+
+    public:
+
+        Worker(ASTManager *manager) : manager(manager) {}
+
+        // the manager of the driver for worker 0
+        ASTManager *manager;
+        std::unique_ptr<ASTManager> ownManager;
+        std::vector<std::unique_ptr<BasicChecker>> forks;
+        CFGVisitor visitor;
+    };
+
+    ASTResource &resource;
+    ASTManager &manager;
+    CallGraph &callGraph;
+    Config &configure;
+    std::unique_ptr<ThreadPool> ownPool;
+    ThreadPool *pool;
+    std::vector<BasicChecker *> checkers;
+    Worker mainWorker;
+
+    /**
+     * an SCC with the ASTs of its functions that no worker had loaded when it was prefetched.
+     */
+    class PrefetchedSCC {
+
+    public:
+
+        PrefetchedSCC() : SCC(0) {}
+
+        unsigned SCC;
+        std::vector<PrefetchedAST> ASTs;
+    };
+
+    void visit(Worker &worker, ASTFunction *F);
+    void prefetch(const std::vector<Worker *> &workers, unsigned start, PipelineQueue<PrefetchedSCC> &queue);
+
+    CheckDriver(const CheckDriver&);
+    CheckDriver& operator =(const CheckDriver&);
+};
+
+#endif
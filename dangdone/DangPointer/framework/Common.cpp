@@ -7,6 +7,7 @@
 #include "clang/AST/RecursiveASTVisitor.h"
 
 #include "clang/Frontend/CompilerInstance.h"
+#include "clang/Lex/Lexer.h"
 
 using namespace std;
 
@@ -81,6 +82,63 @@ private:
     std::set<FunctionDecl *> functions;
 };
 
+class ASTFunctionDeclLoad : public RecursiveASTVisitor<ASTFunctionDeclLoad> {
+
+public:
+    bool VisitFunctionDecl(FunctionDecl *FD) {
+        functions.push_back(FD);
+        return true;
+    }
+
+    const std::vector<FunctionDecl *> &getFunctions() const {
+        return functions;
+    }
+
+private:
+    std::vector<FunctionDecl *> functions;
+};
+
+/**
+ * the declarations a function body refers to, with their types, in the order they are first used.
+ */
+class ASTReferencedDeclLoad : public RecursiveASTVisitor<ASTReferencedDeclLoad> {
+
+public:
+    bool VisitDeclRefExpr(DeclRefExpr *E) {
+        add(E->getDecl());
+        return true;
+    }
+
+    bool VisitMemberExpr(MemberExpr *E) {
+        add(E->getMemberDecl());
+        return true;
+    }
+
+    const std::string &getText() const {
+        return text;
+    }
+
+private:
+    std::set<const ValueDecl *> seen;
+    std::string text;
+
+    void add(const ValueDecl *D) {
+        if (D == nullptr || !seen.insert(D).second) {
+            return;
+        }
+        QualType type = D->getType();
+        text += D->getQualifiedNameAsString() + ":" + type.getAsString() + ":" + type.getCanonicalType().getAsString();
+        // an initializer of a global constant may be folded into the function
+        const VarDecl *VD = dyn_cast<VarDecl>(D);
+        if (VD != nullptr && VD->hasGlobalStorage() && type.isConstQualified() && VD->getInit() != nullptr) {
+            llvm::raw_string_ostream init(text);
+            VD->getInit()->printPretty(init, nullptr, PrintingPolicy(D->getASTContext().getLangOpts()));
+            init.flush();
+        }
+        text += ";";
+    }
+};
+
 class ASTCallExprLoad: public RecursiveASTVisitor<ASTCallExprLoad> {
     
 public:
@@ -122,6 +180,16 @@ std::vector<FunctionDecl *> getFunctions(ASTContext &Context) {
     return load.getFunctions();
 }
 
+/**
+ * get all function decls of an ast context, including declarations without a body.
+ */
+std::vector<FunctionDecl *> getFunctionDecls(ASTContext &Context) {
+
+    ASTFunctionDeclLoad load;
+    load.TraverseDecl(Context.getTranslationUnitDecl());
+    return load.getFunctions();
+}
+
 /**
  * get all variables' decl of a function
  * FD : the function decl.
@@ -169,6 +237,68 @@ std::string getFullName(FunctionDecl *FD) {
     return name;
 }
 
+/**
+ * FNV-1a hash of a string.
+ * It is stable across runs, so it can be used as a key of on-disk caches.
+ */
+uint64_t hashString(const std::string &s, uint64_t seed) {
+
+    uint64_t hash = seed;
+    for (unsigned char c : s) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+uint64_t hashCombine(uint64_t seed, uint64_t value) {
+
+    for (int i = 0; i < 8; i++) {
+        seed ^= (value >> (i * 8)) & 0xff;
+        seed *= 1099511628211ULL;
+    }
+    return seed;
+}
+
+/**
+ * hash of everything a function's summary and warnings depend on in its own AST:
+ * its full name, the file and line it starts at (warnings have them), its source text,
+ * its body after macro expansion, and the names and types of the declarations it uses.
+ * A function is unchanged only if all of them are.
+ * FD : the function decl.
+ */
+uint64_t getFunctionHash(FunctionDecl *FD) {
+
+    ASTContext &Context = FD->getASTContext();
+    SourceManager &SM = Context.getSourceManager();
+    uint64_t hash = hashString(getFullName(FD));
+
+    PresumedLoc start = SM.getPresumedLoc(SM.getExpansionLoc(FD->getLocStart()));
+    if (start.isValid()) {
+        hash = hashCombine(hashString(start.getFilename(), hash), start.getLine());
+    }
+
+    CharSourceRange range = CharSourceRange::getTokenRange(FD->getSourceRange());
+    std::string text = Lexer::getSourceText(range, SM, Context.getLangOpts()).str();
+    if (text.empty()) {
+        text = FD->getLocStart().printToString(SM);
+    }
+    hash = hashString(text, hash);
+
+    // the printed body is the body after macro expansion, a changed macro changes it
+    if (Stmt *body = FD->getBody()) {
+        std::string expanded;
+        llvm::raw_string_ostream out(expanded);
+        body->printPretty(out, nullptr, PrintingPolicy(Context.getLangOpts()));
+        out.flush();
+        hash = hashString(expanded, hash);
+    }
+
+    ASTReferencedDeclLoad load;
+    load.TraverseDecl(FD);
+    return hashString(load.getText(), hash);
+}
+
 } // end of namespace common
 
 
@@ -201,46 +331,7 @@ std::vector<std::string> initialize(std::string astList) {
 
 void common::printLog(std::string logString, common::CheckerName cn, int level, Config &c)
 {
-	auto block = c.getOptionBlock("PrintLog");
-	int l = atoi(block.find("level")->second.c_str());
-	switch(cn)
-	{
-	case common::CheckerName::taintChecker: 
-		if(block.find("taintChecker")->second == "true" && level>=l)
-		{
-			llvm::errs()<<logString;
-		}
-		break;
-	case common::CheckerName::danglingPointer: 
-		if(block.find("danglingPointer")->second == "true" && level>=l)
-		{
-			llvm::errs()<<logString;
-		}
-		break;
-	case common::CheckerName::arrayBound: 
-		if(block.find("arrayBound")->second == "true" && level>=l)
-		{
-			llvm::errs()<<logString;
-		}
-		break;
-	case common::CheckerName::recursiveCall: 
-		if(block.find("recursiveCall")->second == "true" && level>=l)
-		{
-			llvm::errs()<<logString;
-		}
-		break;
-	case common::CheckerName::divideChecker: 
-		if(block.find("divideChecker")->second == "true" && level>=l)
-		{
-			llvm::errs()<<logString;
-		}
-		break;
-	case common::CheckerName::memoryOPChecker: 
-		if(block.find("memoryOPChecker")->second == "true" && level>=l)
-		{
-			llvm::errs()<<logString;
-		}
-		break;
-	}
+	if(Logger::isLogged(cn, level, c))
+		Logger::write(logString);
 }
 
@@ -6,6 +6,8 @@
 
 #include "clang/Frontend/ASTUnit.h"
 #include "Config.h"
+#include "Logger.h"
+#include "JSON.h"
 
 using namespace clang;
 
@@ -13,19 +15,10 @@ std::vector<std::string> initialize(std::string astList);
 
 namespace common {
 
-	enum CheckerName
-	{
-		taintChecker,
-		danglingPointer,
-		arrayBound,
-		recursiveCall,
-		divideChecker,
-		memoryOPChecker
-	};
-
 std::unique_ptr<ASTUnit> loadFromASTFile(std::string AST);
 
 std::vector<FunctionDecl *> getFunctions(ASTContext &Context);
+std::vector<FunctionDecl *> getFunctionDecls(ASTContext &Context);
 std::vector<VarDecl *> getVariables(FunctionDecl *FD);
 
 std::vector<FunctionDecl *> getCalledFunctions(FunctionDecl *FD);
@@ -33,52 +26,18 @@ std::vector<CallExpr *> getCallExpr(FunctionDecl *FD);
 
 std::string getFullName(FunctionDecl *FD);
 
+uint64_t hashString(const std::string &s, uint64_t seed = 14695981039346656037ULL);
+uint64_t hashCombine(uint64_t seed, uint64_t value);
+uint64_t getFunctionHash(FunctionDecl *FD);
+
+//the message is built even when it is not logged, use CHECKER_LOG in loops.
 void printLog(std::string, CheckerName cn, int level, Config &c);
 
 template<class T> 
 void dumpLog(T &t, CheckerName cn, int level, Config &c)
 {
-	auto block = c.getOptionBlock("PrintLog");
-	int l = atoi(block.find("level")->second.c_str());
-	switch(cn)
-	{
-	case common::CheckerName::taintChecker: 
-		if(block.find("taintChecker")->second == "true" && level>=l)
-		{
-			t.dump();
-		}
-		break;
-	case common::CheckerName::danglingPointer: 
-		if(block.find("danglingPointer")->second == "true" && level>=l)
-		{
-			t.dump();
-		}
-		break;
-	case common::CheckerName::arrayBound: 
-		if(block.find("arrayBound")->second == "true" && level>=l)
-		{
-			t.dump();
-		}
-		break;
-	case common::CheckerName::recursiveCall: 
-		if(block.find("recursiveCall")->second == "true" && level>=l)
-		{
-			t.dump();
-		}
-		break;
-	case common::CheckerName::divideChecker: 
-		if(block.find("divideChecker")->second == "true" && level>=l)
-		{
-			t.dump();
-		}
-		break;
-	case common::CheckerName::memoryOPChecker: 
-		if(block.find("memoryOPChecker")->second == "true" && level>=l)
-		{
-			t.dump();
-		}
-		break;
-	}
+	if(Logger::isLogged(cn, level, c))
+		t.dump();
 }
 } // end of namespace common
 
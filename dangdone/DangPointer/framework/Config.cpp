@@ -1,5 +1,8 @@
 #include "Config.h"
 
+#include <cstdlib>
+#include <sstream>
+
 
 Config::Config(std::string configFile)
 {
@@ -38,8 +41,128 @@ Config::Config(std::string configFile)
 		}
 		
 	}
+	compileLogOptions();
+	compileCheckOptions();
 }
 
+//names of the checkers in the PrintLog block, in the order of common::CheckerName.
+void Config::compileLogOptions()
+{
+	static const char *const checkers[LOG_CHECKERS] = {
+		"taintChecker",
+		"danglingPointer",
+		"arrayBound",
+		"recursiveCall",
+		"divideChecker",
+		"memoryOPChecker"
+	};
+	logOptions = LogOptions();
+	std::unordered_map<std::string,std::unordered_map<std::string, std::string>>::const_iterator block = options.find("PrintLog");
+	if(block == options.end())
+		return;
+	std::unordered_map<std::string, std::string>::const_iterator got = block->second.find("level");
+	int level = got == block->second.end() ? 0 : atoi(got->second.c_str());
+	got = block->second.find("bufferSize");
+	if(got != block->second.end())
+		logOptions.bufferSize = strtoul(got->second.c_str(), nullptr, 10);
+	got = block->second.find("dropPolicy");
+	logOptions.dropOnFull = got != block->second.end() && got->second == "drop";
+	for(int i = 0; i < LOG_CHECKERS; i++)
+	{
+		got = block->second.find(checkers[i]);
+		if(got != block->second.end() && got->second == "true")
+			logOptions.thresholds[i] = level;
+	}
+}
+
+void Config::compileCheckOptions()
+{
+	checkOptions = CheckOptions();
+	std::unordered_map<std::string,std::unordered_map<std::string, std::string>>::const_iterator block = options.find("DanglingPointer");
+	if(block != options.end())
+	{
+		const std::unordered_map<std::string, std::string> &ptrConfig = block->second;
+		std::unordered_map<std::string, std::string>::const_iterator got = ptrConfig.find("levelOfDete");
+		if(got != ptrConfig.end())
+		{
+			checkOptions.levelOfDete = atoi(got->second.c_str());
+			checkOptions.defaultLevelOfDete = false;
+		}
+		got = ptrConfig.find("adaptiveLevel");
+		checkOptions.adaptiveLevel = got != ptrConfig.end() && got->second == "true";
+		got = ptrConfig.find("maxLevelOfDete");
+		if(got != ptrConfig.end())
+			checkOptions.maxLevelOfDete = atoi(got->second.c_str());
+		got = ptrConfig.find("ifRegardParAsFreelike");
+		if(got != ptrConfig.end())
+		{
+			checkOptions.regardParAsFreelike = got->second == "true";
+			checkOptions.defaultRegardParAsFreelike = false;
+		}
+		got = ptrConfig.find("pointsTo");
+		checkOptions.pointsTo = got != ptrConfig.end() && got->second == "true";
+		got = ptrConfig.find("summaryCache");
+		if(got != ptrConfig.end())
+			checkOptions.summaryCache = got->second;
+		//reportFormat: comma separated list of xml, sarif, jsonl and index.
+		got = ptrConfig.find("reportFormat");
+		if(got != ptrConfig.end() && got->second != "")
+		{
+			checkOptions.reportFormats.clear();
+			std::stringstream formats(got->second);
+			for(std::string format; std::getline(formats, format, ',');)
+			{
+				format = trim(format);
+				if(format != "")
+					checkOptions.reportFormats.push_back(format);
+			}
+		}
+		unsigned *const numbers[] = {
+			&checkOptions.maxBlocks,
+			&checkOptions.maxStatements,
+			&checkOptions.maxTime,
+			&checkOptions.residentSummaries,
+			&checkOptions.profileTop,
+			&checkOptions.checkpointInterval
+		};
+		static const char *const names[] = {
+			"maxBlocks",
+			"maxStatements",
+			"maxTime",
+			"residentSummaries",
+			"profileTop",
+			"checkpointInterval"
+		};
+		for(unsigned i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+		{
+			got = ptrConfig.find(names[i]);
+			if(got != ptrConfig.end())
+				*numbers[i] = strtoul(got->second.c_str(), nullptr, 10);
+		}
+	}
+	block = options.find("Framework");
+	if(block != options.end())
+	{
+		std::unordered_map<std::string, std::string>::const_iterator got = block->second.find("threads");
+		if(got != block->second.end() && got->second != "")
+			checkOptions.threads = strtoul(got->second.c_str(), nullptr, 10);
+		got = block->second.find("prefetch");
+		if(got != block->second.end() && got->second != "")
+			checkOptions.prefetch = strtoul(got->second.c_str(), nullptr, 10);
+	}
+	block = options.find("Run");
+	if(block != options.end())
+	{
+		std::unordered_map<std::string, std::string>::const_iterator got = block->second.find("resume");
+		checkOptions.resume = got != block->second.end() && got->second == "true";
+	}
+	block = options.find("MemoryReleaseFunction");
+	if(block != options.end())
+	{
+		for(auto &content : block->second)
+			checkOptions.releaseFunctions[content.first] = atoi(content.second.c_str());
+	}
+}
 
 std::pair<std::string, std::string> Config::parseOptionLine(std::string optionLine)
 {
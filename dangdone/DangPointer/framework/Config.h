@@ -5,14 +5,85 @@
 #include <fstream>
 #include <iostream>
 #include <set>
+#include <map>
+#include <vector>
 #include <unordered_map>
 #include <unordered_set>
+#include <climits>
+
+//number of checkers of common::CheckerName
+#define LOG_CHECKERS 6
+
+/**
+ * the PrintLog block, compiled when the config is read so a log call does not look it up.
+ * thresholds[cn] is the lowest level logged for the checker cn, DISABLED when its log is off.
+ */
+class LogOptions
+{
+public:
+	static const int DISABLED = INT_MAX;
+	LogOptions() : bufferSize(0), dropOnFull(false)
+	{
+		for(int &threshold : thresholds)
+			threshold = DISABLED;
+	}
+	int thresholds[LOG_CHECKERS];
+	//messages go through a ring of bufferSize messages written by a background thread, 0 writes them synchronously.
+	unsigned bufferSize;
+	//a message logged while the ring is full is dropped, or its thread waits for room
+	bool dropOnFull;
+};
+
+/**
+ * the DanglingPointer, MemoryReleaseFunction and Run blocks and the threads and prefetch of the Framework block,
+ * compiled when the config is read: they are read on every check() and by the manager of every worker,
+ * which would otherwise copy the blocks each time. A missing option has its default.
+ */
+class CheckOptions
+{
+public:
+	CheckOptions() : levelOfDete(2), defaultLevelOfDete(true), adaptiveLevel(false), maxLevelOfDete(0),
+		regardParAsFreelike(true), defaultRegardParAsFreelike(true), pointsTo(false),
+		maxBlocks(0), maxStatements(0), maxTime(0), residentSummaries(0), profileTop(0),
+		checkpointInterval(0), resume(false), threads(1), prefetch(1)
+	{
+		reportFormats.push_back("xml");
+		reportFormats.push_back("index");
+	}
+	int levelOfDete;
+	bool defaultLevelOfDete;
+	bool adaptiveLevel;
+	//0 when not set
+	int maxLevelOfDete;
+	bool regardParAsFreelike;
+	bool defaultRegardParAsFreelike;
+	bool pointsTo;
+	std::string summaryCache;
+	std::vector<std::string> reportFormats;
+	unsigned maxBlocks;
+	unsigned maxStatements;
+	unsigned maxTime;
+	unsigned residentSummaries;
+	unsigned profileTop;
+	unsigned checkpointInterval;
+	bool resume;
+	//0 means one thread per core
+	unsigned threads;
+	//SCCs prepared ahead of each worker, 0 turns the prefetch stage off
+	unsigned prefetch;
+	//name = index of the released argument, sorted so it can be hashed
+	std::map<std::string, int> releaseFunctions;
+};
 
 class Config
 {
 	std::unordered_map<std::string, std::unordered_map<std::string,std::string>> options;
+	LogOptions logOptions;
+	CheckOptions checkOptions;
 	std::pair<std::string, std::string> parseOptionLine(std::string optionLine);
 	std::string trim(std::string s);
+	void compileLogOptions();
+	void compileCheckOptions();
 public:
 	Config(std::string configFile);
 	std::unordered_map<std::string, std::string> getOptionBlock(std::string blockName);
@@ -20,7 +91,19 @@ public:
 	std::unordered_map<std::string, std::unordered_map<std::string,std::string>> getAllOptionBlocks();
     void add(std::string name, std::unordered_map<std::string, std::string> content) {
         options[name] = content;
+        if (name == "PrintLog")
+            compileLogOptions();
+        else
+            compileCheckOptions();
     }
+	const LogOptions &getLogOptions() const
+	{
+		return logOptions;
+	}
+	const CheckOptions &getCheckOptions() const
+	{
+		return checkOptions;
+	}
 };
 
 
@@ -0,0 +1,73 @@
+#ifndef COUNTING_ALLOCATOR_H
+#define COUNTING_ALLOCATOR_H
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+#include "Metrics.h"
+
+/**
+ * a std::allocator accounting the bytes of a container to a subsystem of Metrics.
+ * It only adds two relaxed atomic operations to an allocation, so it is always on.
+ */
+template <typename T, Metrics::Memory M>
+class CountingAllocator {
+
+public:
+
+    typedef T value_type;
+    typedef T *pointer;
+    typedef const T *const_pointer;
+    typedef T &reference;
+    typedef const T &const_reference;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    template <typename U>
+    struct rebind {
+        typedef CountingAllocator<U, M> other;
+    };
+
+    CountingAllocator() {}
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U, M> &) {}
+
+    T *allocate(std::size_t n, const void * = nullptr) {
+        T *p = static_cast<T *>(::operator new(n * sizeof(T)));
+        Metrics::allocate(M, n * sizeof(T));
+        return p;
+    }
+
+    void deallocate(T *p, std::size_t n) {
+        Metrics::release(M, n * sizeof(T));
+        ::operator delete(p);
+    }
+
+    std::size_t max_size() const {
+        return std::size_t(-1) / sizeof(T);
+    }
+
+    template <typename U, typename... Args>
+    void construct(U *p, Args&&... args) {
+        ::new((void *)p) U(std::forward<Args>(args)...);
+    }
+
+    template <typename U>
+    void destroy(U *p) {
+        p->~U();
+    }
+};
+
+template <typename T, typename U, Metrics::Memory M>
+bool operator ==(const CountingAllocator<T, M> &, const CountingAllocator<U, M> &) {
+    return true;
+}
+
+template <typename T, typename U, Metrics::Memory M>
+bool operator !=(const CountingAllocator<T, M> &, const CountingAllocator<U, M> &) {
+    return false;
+}
+
+#endif
@@ -0,0 +1,149 @@
+#include "DataFlow.h"
+
+#include <queue>
+#include <algorithm>
+#include <functional>
+
+BitVectorDataFlow::BitVectorDataFlow(const CFG &cfg, unsigned size, Direction direction, Meet meet) :
+    cfg(cfg), size(size), direction(direction), meet(meet), iterations(0) {
+
+    unsigned blocks = cfg.getNumBlockIDs();
+    gens.assign(blocks, llvm::BitVector(size));
+    kills.assign(blocks, llvm::BitVector(size));
+    in.assign(blocks, llvm::BitVector(size));
+    out.assign(blocks, llvm::BitVector(size));
+}
+
+void BitVectorDataFlow::gen(const CFGBlock *B, unsigned i) {
+
+    gens[B->getBlockID()].set(i);
+    kills[B->getBlockID()].reset(i);
+}
+
+void BitVectorDataFlow::kill(const CFGBlock *B, unsigned i) {
+
+    kills[B->getBlockID()].set(i);
+    gens[B->getBlockID()].reset(i);
+}
+
+/**
+ * reverse postorder of the blocks reachable from the entry (the exit for BACKWARD),
+ * so a block is mostly visited after the blocks flowing into it.
+ */
+std::vector<const CFGBlock *> BitVectorDataFlow::getOrder() const {
+
+    std::vector<const CFGBlock *> order;
+    std::vector<bool> visited(cfg.getNumBlockIDs(), false);
+    // the blocks being visited and the next neighbour to visit of each
+    std::vector<std::pair<const CFGBlock *, unsigned>> stack;
+
+    const CFGBlock *start = direction == FORWARD ? &cfg.getEntry() : &cfg.getExit();
+    visited[start->getBlockID()] = true;
+    stack.push_back(std::make_pair(start, 0));
+
+    while (!stack.empty()) {
+        const CFGBlock *B = stack.back().first;
+        unsigned next = stack.back().second;
+        unsigned count = direction == FORWARD ? B->succ_size() : B->pred_size();
+
+        if (next < count) {
+            stack.back().second++;
+            const CFGBlock *N = direction == FORWARD ? *(B->succ_begin() + next) : *(B->pred_begin() + next);
+            if (N != nullptr && !visited[N->getBlockID()]) {
+                visited[N->getBlockID()] = true;
+                stack.push_back(std::make_pair(N, 0));
+            }
+            continue;
+        }
+
+        order.push_back(B);
+        stack.pop_back();
+    }
+
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+void BitVectorDataFlow::solve() {
+
+    // for BACKWARD the facts flow from out to in
+    std::vector<llvm::BitVector> &flowIn = direction == FORWARD ? in : out;
+    std::vector<llvm::BitVector> &flowOut = direction == FORWARD ? out : in;
+
+    std::vector<const CFGBlock *> order = getOrder();
+    const unsigned UNREACHABLE = ~0u;
+    std::vector<unsigned> position(cfg.getNumBlockIDs(), UNREACHABLE);
+    for (unsigned i = 0; i < order.size(); i++) {
+        position[order[i]->getBlockID()] = i;
+    }
+
+    if (meet == MUST) {
+        for (llvm::BitVector &facts : flowOut) {
+            facts.set();
+        }
+    }
+
+    // blocks are taken in the order above, by their position
+    std::priority_queue<unsigned, std::vector<unsigned>, std::greater<unsigned>> worklist;
+    std::vector<bool> queued(order.size(), true);
+    for (unsigned i = 0; i < order.size(); i++) {
+        worklist.push(i);
+    }
+
+    llvm::BitVector facts(size);
+    while (!worklist.empty()) {
+        unsigned i = worklist.top();
+        worklist.pop();
+        queued[i] = false;
+        iterations++;
+
+        const CFGBlock *B = order[i];
+        unsigned id = B->getBlockID();
+
+        // the boundary block starts with no facts
+        bool first = true;
+        facts.reset();
+        if (i != 0) {
+            CFGBlock::const_pred_iterator begin = direction == FORWARD ? B->pred_begin() : B->succ_begin();
+            CFGBlock::const_pred_iterator end = direction == FORWARD ? B->pred_end() : B->succ_end();
+            for (CFGBlock::const_pred_iterator it = begin; it != end; ++it) {
+                const CFGBlock *N = *it;
+                if (N == nullptr) {
+                    continue;
+                }
+                if (first) {
+                    facts = flowOut[N->getBlockID()];
+                    first = false;
+                }
+                else if (meet == MAY) {
+                    facts |= flowOut[N->getBlockID()];
+                }
+                else {
+                    facts &= flowOut[N->getBlockID()];
+                }
+            }
+        }
+        flowIn[id] = facts;
+
+        facts.reset(kills[id]);
+        facts |= gens[id];
+        if (facts == flowOut[id]) {
+            continue;
+        }
+        flowOut[id] = facts;
+
+        CFGBlock::const_succ_iterator begin = direction == FORWARD ? B->succ_begin() : B->pred_begin();
+        CFGBlock::const_succ_iterator end = direction == FORWARD ? B->succ_end() : B->pred_end();
+        for (CFGBlock::const_succ_iterator it = begin; it != end; ++it) {
+            const CFGBlock *N = *it;
+            if (N == nullptr || position[N->getBlockID()] == UNREACHABLE) {
+                continue;
+            }
+            unsigned next = position[N->getBlockID()];
+            if (!queued[next]) {
+                queued[next] = true;
+                worklist.push(next);
+            }
+        }
+    }
+}
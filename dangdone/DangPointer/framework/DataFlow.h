@@ -0,0 +1,81 @@
+#ifndef DATA_FLOW_H
+#define DATA_FLOW_H
+
+#include <vector>
+
+#include <clang/Analysis/CFG.h>
+#include <llvm/ADT/BitVector.h>
+
+using namespace clang;
+
+/**
+ * a worklist gen/kill dataflow analysis over a CFG.
+ * Facts are bits of a dense bitvector, e.g. the variables of a function
+ * indexed by their position in ASTFunction::getVariables().
+ */
+class BitVectorDataFlow {
+
+public:
+
+    enum Direction {
+        FORWARD,
+        BACKWARD
+    };
+
+    /**
+     * MAY joins paths with union, MUST with intersection.
+     */
+    enum Meet {
+        MAY,
+        MUST
+    };
+
+    BitVectorDataFlow(const CFG &cfg, unsigned size, Direction direction = FORWARD, Meet meet = MAY);
+
+    /**
+     * a statement of B sets / clears bit i.
+     * Statements of a block must be added in the direction of the analysis.
+     */
+    void gen(const CFGBlock *B, unsigned i);
+    void kill(const CFGBlock *B, unsigned i);
+
+    void solve();
+
+    /**
+     * facts before / after B in program order, valid after solve().
+     */
+    const llvm::BitVector &getIn(const CFGBlock *B) const {
+        return in[B->getBlockID()];
+    }
+
+    const llvm::BitVector &getOut(const CFGBlock *B) const {
+        return out[B->getBlockID()];
+    }
+
+    /**
+     * number of blocks visited by solve(), for statistics.
+     */
+    unsigned getIterations() const {
+        return iterations;
+    }
+
+private:
+
+    const CFG &cfg;
+    unsigned size;
+    Direction direction;
+    Meet meet;
+
+    // gen and kill of each block, indexed by block id
+    std::vector<llvm::BitVector> gens;
+    std::vector<llvm::BitVector> kills;
+
+    std::vector<llvm::BitVector> in;
+    std::vector<llvm::BitVector> out;
+
+    unsigned iterations;
+
+    std::vector<const CFGBlock *> getOrder() const;
+};
+
+#endif
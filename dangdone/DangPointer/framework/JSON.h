@@ -0,0 +1,43 @@
+#ifndef JSON_H
+#define JSON_H
+
+#include <string>
+
+/**
+ * JSON output shared by the trace, the profile and the reports.
+ * It does not depend on LLVM, so the merge tool uses it as well; Common.h includes it.
+ */
+namespace common {
+
+/**
+ * append text to out as a JSON string, quotes included.
+ */
+inline void appendJSON(std::string &out, const std::string &text) {
+
+    static const char *hex = "0123456789abcdef";
+    out += '"';
+    for (char c : text) {
+        unsigned char ch = (unsigned char)c;
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (ch < 32) {
+                    out += "\\u00";
+                    out += hex[ch >> 4];
+                    out += hex[ch & 15];
+                }
+                else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+} // end of namespace common
+
+#endif
@@ -1,33 +1,236 @@
 #include "Logger.h"
 
-TLogLevel Logger::configurationLevel = LOG_DEBUG_3;
-TCheck Logger::checkType = TAINT_CHECK;
-bool Logger::options[6] = {false, false, false, false, false, false};
-
-void Logger::configure(Config &c) {
-    auto block = c.getOptionBlock("PrintLog");
-    int level = atoi(block.find("level")->second.c_str());
-    switch (level) {
-        case 1: configurationLevel = LOG_DEBUG_1; break;
-        case 2: configurationLevel = LOG_DEBUG_2; break; 
-        case 3: configurationLevel = LOG_DEBUG_3; break;
-        case 4: configurationLevel = LOG_DEBUG_4; break; 
-        case 5: configurationLevel = LOG_DEBUG_5; break; 
-        default: configurationLevel = LOG_DEBUG_3;
-    }
-
-    if(block.find("taintChecker")->second == "true")
-        options[TAINT_CHECK] = true;
-    if(block.find("danglingPointer")->second == "true")
-        options[DANGLING_POINTER] = true;
-    if(block.find("arrayBound")->second == "true")
-        options[ARRAY_BOUND] = true;
-    if(block.find("recursiveCall")->second == "true")
-        options[RECURSIVE_CALL] = true;
-    if(block.find("divideChecker")->second == "true")
-        options[DIVIDE_CHECK] = true;
-    if(block.find("memoryOPChecker")->second == "true")
-        options[MEMORY_OP] = true;
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <stdio.h>
+
+namespace {
+
+/**
+ * a bounded queue of messages with many producers and one consumer.
+ * A producer claims a slot by moving the tail, the sequence of a slot tells whether
+ * it is free for a position or holds the message of a position, so push takes no lock.
+ */
+class LogRing {
+
+public:
+
+    LogRing(unsigned size) : capacity(1), head(0), tail(0) {
+
+        while (capacity < size) {
+            capacity *= 2;
+        }
+        slots.reset(new Slot[capacity]);
+        for (uint64_t i = 0; i < capacity; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * false if the ring is full, message is then left as it is.
+     * filled is set to the number of messages in the ring after the push, about.
+     */
+    bool push(std::string &message, uint64_t &filled) {
+
+        uint64_t position = tail.load(std::memory_order_relaxed);
+        while (true) {
+            Slot &slot = slots[position & (capacity - 1)];
+            uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+            int64_t difference = (int64_t)(sequence - position);
+            if (difference == 0) {
+                if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    slot.message.swap(message);
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    filled = position + 1 - head.load(std::memory_order_relaxed);
+                    return true;
+                }
+            }
+            else if (difference < 0) {
+                return false;
+            }
+            else {
+                position = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * append the next message to out, false if there is none. Only the flusher pops.
+     */
+    bool pop(std::string &out) {
+
+        uint64_t position = head.load(std::memory_order_relaxed);
+        Slot &slot = slots[position & (capacity - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != position + 1) {
+            return false;
+        }
+        out += slot.message;
+        slot.message.clear();
+        slot.sequence.store(position + capacity, std::memory_order_release);
+        head.store(position + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    uint64_t getCapacity() const {
+        return capacity;
+    }
+
+private:
+
+    class Slot {
+
+    public:
+
+        std::atomic<uint64_t> sequence;
+        std::string message;
+    };
+
+    uint64_t capacity;
+    std::unique_ptr<Slot[]> slots;
+    // only the flusher moves the head, producers read it to know how full the ring is
+    std::atomic<uint64_t> head;
+    std::atomic<uint64_t> tail;
+};
+
+std::mutex mutex;
+std::atomic<LogRing *> active(nullptr);
+std::unique_ptr<LogRing> ring;
+bool dropOnFull = false;
+std::atomic<uint64_t> dropped(0);
+// producers between loading active and the end of their push, stop() waits for them
+std::atomic<unsigned> writers(0);
+std::thread flusher;
+bool stopping = false;
+bool registered = false;
+std::mutex wakeMutex;
+std::condition_variable wake;
+thread_local std::string threadTag;
+
+void writeOut(const std::string &text) {
+
+    fwrite(text.data(), 1, text.size(), stderr);
+    fflush(stderr);
+}
+
+/**
+ * write the messages of the ring in batches until stop(), then drain it.
+ * Producers only wake the flusher when the ring is half full or full,
+ * otherwise it writes what is in the ring every 20ms.
+ */
+void flush() {
+
+    std::string batch;
+    uint64_t reported = 0;
+    while (true) {
+        bool last;
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wake.wait_for(lock, std::chrono::milliseconds(20));
+            last = stopping;
+        }
+        while (ring->pop(batch)) {
+            if (batch.size() >= 64 * 1024) {
+                writeOut(batch);
+                batch.clear();
+            }
+        }
+        uint64_t lost = dropped.load(std::memory_order_relaxed);
+        if (lost != reported) {
+            batch += "logger: " + std::to_string(lost - reported) + " messages dropped\n";
+            reported = lost;
+        }
+        if (!batch.empty()) {
+            writeOut(batch);
+            batch.clear();
+        }
+        if (last) {
+            return;
+        }
+    }
+}
+
+} // end of anonymous namespace
+
+void Logger::write(const std::string &message) {
+
+    std::string text = threadTag.empty() ? message : "[" + threadTag + "] " + message;
+    // counted before active is read, so stop() does not drain the ring before this push
+    writers.fetch_add(1);
+    LogRing *current = active.load();
+    if (current == nullptr) {
+        writers.fetch_sub(1);
+        std::lock_guard<std::mutex> lock(mutex);
+        writeOut(text);
+        return;
+    }
+    uint64_t filled;
+    while (!current->push(text, filled)) {
+        if (dropOnFull) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            writers.fetch_sub(1);
+            return;
+        }
+        // backpressure: the flusher is behind, wait for it to make room
+        wake.notify_one();
+        std::this_thread::yield();
+    }
+    writers.fetch_sub(1);
+    if (filled * 2 >= current->getCapacity()) {
+        wake.notify_one();
+    }
+}
+
+void Logger::start(const LogOptions &options) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (options.bufferSize == 0 || ring != nullptr) {
+        return;
+    }
+    ring.reset(new LogRing(options.bufferSize));
+    dropOnFull = options.dropOnFull;
+    stopping = false;
+    flusher = std::thread(flush);
+    active.store(ring.get());
+    // a run ending with exit() still writes its last messages
+    if (!registered) {
+        registered = true;
+        atexit(Logger::stop);
+    }
+}
+
+/**
+ * new messages are written synchronously, the ones being pushed are waited for before the last drain.
+ */
+void Logger::stop() {
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (active.load() == nullptr) {
+        return;
+    }
+    active.store(nullptr);
+    while (writers.load() != 0) {
+        std::this_thread::yield();
+    }
+    {
+        std::lock_guard<std::mutex> wakeLock(wakeMutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    flusher.join();
+    ring.reset();
+}
+
+void Logger::setThreadTag(const std::string &tag) {
+
+    threadTag = tag;
 }
 
+uint64_t Logger::getDropped() {
 
+    return dropped.load(std::memory_order_relaxed);
+}
@@ -1,86 +1,81 @@
 #ifndef _LOGGER_H
 #define _LOGGER_H
 
-#include <sstream>
 #include <string>
-#include <stdio.h>
 
-#include "Config.h"
+#include <stdint.h>
 
-inline std::string NowTime();
+#include "Config.h"
 
-enum TLogLevel {
-    LOG_DEBUG_1,
-    LOG_DEBUG_2,
-    LOG_DEBUG_3,
-    LOG_DEBUG_4,
-    LOG_DEBUG_5
-};
+namespace common {
 
-enum TCheck {
-    ARRAY_BOUND,
-    DANGLING_POINTER,
-    DIVIDE_CHECK,
-    MEMORY_OP,
-    RECURSIVE_CALL,
-    TAINT_CHECK
-};
+	enum CheckerName
+	{
+		taintChecker,
+		danglingPointer,
+		arrayBound,
+		recursiveCall,
+		divideChecker,
+		memoryOPChecker
+	};
 
-class Logger{
-    public:
-        Logger();
-        virtual ~Logger();
-        std::ostringstream& log(TCheck t, TLogLevel level = LOG_DEBUG_3);
-
-    public:
-        static void configure(Config &c);
-        static void setCheckType(TCheck t);
-        static TLogLevel& getConfigurationLevel();
-        static std::string ToString(TLogLevel level);
-
-    protected:
-        std::ostringstream os;
-
-    private:
-        Logger(const Logger&);
-        Logger& operator =(const Logger&);
-        
-    private:
-        TLogLevel messageLevel;
-        static TLogLevel configurationLevel;
-        static TCheck checkType;
-        static bool options[6];
-};
+} // end of namespace common
 
-inline Logger::Logger() {
-     
-}
+/**
+ * the log of the checkers, written to stderr.
+ * Whether a message is logged only reads the thresholds Config compiled from the PrintLog block,
+ * so a disabled CHECKER_LOG is one branch and its message is not built.
+ * After start(), messages are put in a lock-free ring and written in batches by a background thread.
+ */
+class Logger {
 
-inline std::ostringstream& Logger::log(TCheck t, TLogLevel level) {
-    messageLevel = level;
-    checkType = t;
-    return os;
-}
+public:
 
-inline Logger::~Logger() {
-    if (messageLevel >= Logger::getConfigurationLevel() && options[checkType] ) {
-        fprintf(stderr, "%s", os.str().c_str());
-        fflush(stderr);
+    static bool isLogged(common::CheckerName cn, int level, const Config &c) {
+        return level >= c.getLogOptions().thresholds[cn];
     }
-}
-
-inline TLogLevel& Logger::getConfigurationLevel() {
-    return configurationLevel;
-}
-
-inline std::string Logger::ToString(TLogLevel level) {
-    static const char* const buffer[] = {
-        "DEBUG_1",
-        "DEBUG_2",
-        "DEBUG_3",
-        "DEBUG_4",
-        "DEBUG_5"
-    };
-    return buffer[level];
-}
+
+    /**
+     * write a message, messages of threads running together are not mixed.
+     * A message of a thread with a tag starts with "[tag] ".
+     */
+    static void write(const std::string &message);
+
+    /**
+     * write the messages from now on through a ring of options.bufferSize messages,
+     * nothing is done if it is 0. The ring is drained by stop() or at exit.
+     */
+    static void start(const LogOptions &options);
+
+    /**
+     * write the messages left in the ring and write synchronously again.
+     * It is called once the threads logging are done.
+     */
+    static void stop();
+
+    /**
+     * tag of the messages of the calling thread, e.g. its worker.
+     */
+    static void setThreadTag(const std::string &tag);
+
+    /**
+     * number of messages dropped because the ring was full.
+     */
+    static uint64_t getDropped();
+
+private:
+
+    Logger();
+};
+
+/**
+ * log message for the checker cn at level, message is only evaluated when it is logged:
+ * CHECKER_LOG(common::CheckerName::danglingPointer, 2, *configure, "Function: " + funName + " begin\n");
+ */
+#define CHECKER_LOG(cn, level, c, message) \
+    do { \
+        if (Logger::isLogged(cn, level, c)) \
+            Logger::write(message); \
+    } while (0)
+
 #endif
@@ -0,0 +1,264 @@
+#include "Metrics.h"
+
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+
+#include <sys/time.h>
+#include <sys/resource.h>
+
+std::atomic<uint64_t> Metrics::counters[Metrics::COUNTERS];
+std::atomic<uint64_t> Metrics::memoryCurrent[Metrics::MEMORIES];
+std::atomic<uint64_t> Metrics::memoryPeak[Metrics::MEMORIES];
+std::mutex Metrics::mutex;
+std::vector<Metrics::Phase> Metrics::phases;
+std::vector<Metrics::Queue> Metrics::queues;
+bool Metrics::perfCounters = false;
+std::vector<const PerfCounters *> Metrics::workerCounters;
+
+namespace {
+
+const char *const counterNames[Metrics::COUNTERS] = {
+    "astLoaded",
+    "astEvicted",
+    "cfgBuilt",
+    "functionsVisited",
+    "cacheHits",
+    "cacheMisses",
+    "astCacheHits",
+    "astCacheMisses",
+    "warnings",
+    "varInfoMax",
+    "funInfoMax"
+};
+
+const char *const memoryNames[Metrics::MEMORIES] = {
+    "ast",
+    "cfg",
+    "bimap",
+    "checker",
+    "summaries"
+};
+
+double getSeconds(const timeval &time) {
+
+    return time.tv_sec + time.tv_usec / 1e6;
+}
+
+} // end of anonymous namespace
+
+void Metrics::addPhase(const Phase &phase) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+    phases.push_back(phase);
+}
+
+void Metrics::accumulatePhase(const Phase &phase) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (Phase &sum : phases) {
+        if (sum.name != phase.name) {
+            continue;
+        }
+        sum.wall += phase.wall;
+        sum.cpu += phase.cpu;
+        sum.peakRSS = std::max(sum.peakRSS, phase.peakRSS);
+        sum.minorFaults += phase.minorFaults;
+        sum.majorFaults += phase.majorFaults;
+        sum.contextSwitches += phase.contextSwitches;
+        sum.hardware = sum.hardware && phase.hardware;
+        for (int i = 0; i < PerfCounters::EVENTS; i++) {
+            sum.events[i] += phase.events[i];
+        }
+        sum.count += phase.count;
+        return;
+    }
+    phases.push_back(phase);
+}
+
+std::vector<Metrics::Phase> Metrics::getPhases() {
+
+    std::lock_guard<std::mutex> lock(mutex);
+    return phases;
+}
+
+void Metrics::addQueue(const Queue &queue) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+    queues.push_back(queue);
+}
+
+void Metrics::reset() {
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (unsigned i = 0; i < COUNTERS; i++) {
+        counters[i].store(0, std::memory_order_relaxed);
+    }
+    for (unsigned i = 0; i < MEMORIES; i++) {
+        memoryPeak[i].store(memoryCurrent[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    phases.clear();
+    queues.clear();
+}
+
+bool Metrics::write(std::string path) {
+
+    std::ofstream fout(path);
+    if (!fout.is_open()) {
+        return false;
+    }
+
+    fout << std::fixed << std::setprecision(3);
+    fout << "{\n\"phases\": [";
+    std::vector<Phase> all = getPhases();
+    for (unsigned i = 0; i < all.size(); i++) {
+        const Phase &phase = all[i];
+        fout << (i == 0 ? "\n" : ",\n");
+        fout << "{\"name\": \"" << phase.name << "\", \"wall\": " << phase.wall << ", \"cpu\": " << phase.cpu
+            << ", \"peakRSS\": " << phase.peakRSS << ", \"minorFaults\": " << phase.minorFaults
+            << ", \"majorFaults\": " << phase.majorFaults << ", \"contextSwitches\": " << phase.contextSwitches;
+        if (phase.count != 1) {
+            fout << ", \"count\": " << phase.count;
+        }
+        // without hardware counters the phase only has the measures above
+        if (perfCounters) {
+            fout << ", \"hardware\": " << (phase.hardware ? "true" : "false");
+        }
+        if (phase.hardware) {
+            for (int e = 0; e < PerfCounters::EVENTS; e++) {
+                fout << ", \"" << PerfCounters::getName((PerfCounters::Event)e) << "\": " << phase.events[e];
+            }
+        }
+        fout << "}";
+    }
+    fout << "\n],\n\"queues\": [";
+    std::vector<Queue> allQueues;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        allQueues = queues;
+    }
+    for (unsigned i = 0; i < allQueues.size(); i++) {
+        const Queue &queue = allQueues[i];
+        fout << (i == 0 ? "\n" : ",\n");
+        fout << "{\"name\": \"" << queue.name << "\", \"capacity\": " << queue.capacity << ", \"items\": " << queue.items
+            << ", \"maxDepth\": " << queue.maxDepth << ", \"meanDepth\": " << queue.meanDepth
+            << ", \"pushStall\": " << queue.pushStall << ", \"popStall\": " << queue.popStall << "}";
+    }
+    fout << "\n],\n\"counters\": {";
+    for (unsigned i = 0; i < COUNTERS; i++) {
+        fout << (i == 0 ? "\n" : ",\n");
+        fout << "\"" << counterNames[i] << "\": " << get((Counter)i);
+    }
+    fout << "\n},\n\"memory\": {";
+    for (unsigned i = 0; i < MEMORIES; i++) {
+        fout << (i == 0 ? "\n" : ",\n");
+        fout << "\"" << memoryNames[i] << "\": {\"current\": " << getCurrent((Memory)i) << ", \"peak\": " << getPeak((Memory)i) << "}";
+    }
+    fout << "\n}\n}\n";
+    return true;
+}
+
+void Metrics::addWorkerCounters(const PerfCounters *counters) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+    workerCounters.push_back(counters);
+}
+
+void Metrics::removeWorkerCounters(const PerfCounters *counters) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+    workerCounters.erase(std::remove(workerCounters.begin(), workerCounters.end(), counters), workerCounters.end());
+}
+
+void Metrics::addWorkerEvents(uint64_t values[PerfCounters::EVENTS]) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const PerfCounters *worker : workerCounters) {
+        uint64_t events[PerfCounters::EVENTS];
+        worker->read(events);
+        for (int i = 0; i < PerfCounters::EVENTS; i++) {
+            values[i] += events[i];
+        }
+    }
+}
+
+/**
+ * counters of the calling thread, opened with its first thread phase.
+ */
+const PerfCounters *MetricsPhase::getCounters() {
+
+    if (!Metrics::isPerfCounters()) {
+        return nullptr;
+    }
+    if (!thread) {
+        return counters.isOpen() ? &counters : nullptr;
+    }
+    thread_local PerfCounters threadCounters;
+    thread_local bool opened = false;
+    if (!opened) {
+        opened = true;
+        threadCounters.open(false);
+    }
+    return threadCounters.isOpen() ? &threadCounters : nullptr;
+}
+
+MetricsPhase::MetricsPhase(std::string name, bool thread) :
+    thread(thread), ended(false), start(std::chrono::steady_clock::now()) {
+
+    phase.name = name;
+    if (Metrics::isPerfCounters() && !thread) {
+        counters.open(true);
+    }
+    const PerfCounters *events = getCounters();
+    if (events != nullptr) {
+        events->read(startEvents);
+        if (!thread) {
+            Metrics::addWorkerEvents(startEvents);
+        }
+    }
+
+    rusage usage;
+    getrusage(thread ? RUSAGE_THREAD : RUSAGE_SELF, &usage);
+    startCPU = getSeconds(usage.ru_utime) + getSeconds(usage.ru_stime);
+    startMinorFaults = usage.ru_minflt;
+    startMajorFaults = usage.ru_majflt;
+    startContextSwitches = usage.ru_nvcsw + usage.ru_nivcsw;
+}
+
+const Metrics::Phase &MetricsPhase::end() {
+
+    if (ended) {
+        return phase;
+    }
+    ended = true;
+
+    rusage usage;
+    getrusage(thread ? RUSAGE_THREAD : RUSAGE_SELF, &usage);
+    phase.wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    phase.cpu = getSeconds(usage.ru_utime) + getSeconds(usage.ru_stime) - startCPU;
+    phase.peakRSS = usage.ru_maxrss;
+    phase.minorFaults = usage.ru_minflt - startMinorFaults;
+    phase.majorFaults = usage.ru_majflt - startMajorFaults;
+    phase.contextSwitches = usage.ru_nvcsw + usage.ru_nivcsw - startContextSwitches;
+
+    const PerfCounters *events = getCounters();
+    if (events != nullptr) {
+        events->read(phase.events);
+        if (!thread) {
+            Metrics::addWorkerEvents(phase.events);
+        }
+        for (int i = 0; i < PerfCounters::EVENTS; i++) {
+            phase.events[i] -= startEvents[i];
+        }
+        phase.hardware = true;
+    }
+    counters.close();
+
+    if (thread) {
+        Metrics::accumulatePhase(phase);
+    }
+    else {
+        Metrics::addPhase(phase);
+    }
+    return phase;
+}
@@ -0,0 +1,241 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+
+#include <stdint.h>
+
+#include "PerfCounters.h"
+
+/**
+ * statistics of a run: the cost of its phases and counters of the work done,
+ * written as JSON next to the report so runs can be compared.
+ * Counters are atomic, the checker workers update them together.
+ */
+class Metrics {
+
+public:
+
+    enum Counter {
+        AST_LOADED,
+        AST_EVICTED,
+        CFG_BUILT,
+        FUNCTIONS_VISITED,
+        CACHE_HITS,
+        CACHE_MISSES,
+        // ASTs taken from the AST cache of a batch, and loaded from their file
+        AST_CACHE_HITS,
+        AST_CACHE_MISSES,
+        WARNINGS,
+        // high-water marks of the VarInfo and FunInfo lists of a function
+        VARINFO_MAX,
+        FUNINFO_MAX,
+        COUNTERS
+    };
+
+    /**
+     * subsystems whose memory is accounted: the ASTUnits loaded, the CFGs built,
+     * the bimaps of the managers, the VarInfo and FunInfo lists of the checkers
+     * and the summaries in the summary table.
+     */
+    enum Memory {
+        MEMORY_AST,
+        MEMORY_CFG,
+        MEMORY_BIMAP,
+        MEMORY_CHECKER,
+        MEMORY_SUMMARIES,
+        MEMORIES
+    };
+
+    /**
+     * resources used by a phase, times in seconds.
+     * peakRSS is the peak of the process at the end of the phase, in KB.
+     * events are the hardware counters, set when hardware is true.
+     * A phase run count times, e.g. building a CFG, is the sum of its runs.
+     */
+    class Phase {
+
+    public:
+
+        Phase() : wall(0), cpu(0), peakRSS(0), minorFaults(0), majorFaults(0), contextSwitches(0),
+            hardware(false), count(1) {
+            for (uint64_t &event : events) {
+                event = 0;
+            }
+        }
+
+        std::string name;
+        double wall;
+        double cpu;
+        long peakRSS;
+        long minorFaults;
+        long majorFaults;
+        long contextSwitches;
+        bool hardware;
+        uint64_t events[PerfCounters::EVENTS];
+        unsigned count;
+    };
+
+    /**
+     * a bounded queue between stages of a pipeline: the most items and the mean number of items
+     * it held when one was taken, and the seconds producers waited for room (pushStall) and
+     * the consumer waited for an item (popStall).
+     */
+    class Queue {
+
+    public:
+
+        Queue() : capacity(0), items(0), maxDepth(0), meanDepth(0), pushStall(0), popStall(0) {}
+
+        std::string name;
+        unsigned capacity;
+        uint64_t items;
+        unsigned maxDepth;
+        double meanDepth;
+        double pushStall;
+        double popStall;
+    };
+
+    static void add(Counter counter, uint64_t n = 1) {
+        counters[counter].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    /**
+     * raise a high-water mark to value.
+     */
+    static void max(Counter counter, uint64_t value) {
+        uint64_t current = counters[counter].load(std::memory_order_relaxed);
+        while (value > current && !counters[counter].compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    static uint64_t get(Counter counter) {
+        return counters[counter].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * account bytes allocated by a subsystem, and raise its peak.
+     */
+    static void allocate(Memory memory, uint64_t bytes) {
+        uint64_t current = memoryCurrent[memory].fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        uint64_t peak = memoryPeak[memory].load(std::memory_order_relaxed);
+        while (current > peak && !memoryPeak[memory].compare_exchange_weak(peak, current, std::memory_order_relaxed)) {
+        }
+    }
+
+    static void release(Memory memory, uint64_t bytes) {
+        memoryCurrent[memory].fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    static uint64_t getCurrent(Memory memory) {
+        return memoryCurrent[memory].load(std::memory_order_relaxed);
+    }
+
+    static uint64_t getPeak(Memory memory) {
+        return memoryPeak[memory].load(std::memory_order_relaxed);
+    }
+
+    static void addPhase(const Phase &phase);
+    /**
+     * add a run of a phase to the phase of the same name.
+     */
+    static void accumulatePhase(const Phase &phase);
+    static std::vector<Phase> getPhases();
+
+    static void addQueue(const Queue &queue);
+
+    /**
+     * start the metrics of the next run of a batch: counters, phases and queues are cleared,
+     * the peaks of memory start again from the memory in use.
+     */
+    static void reset();
+
+    /**
+     * measure phases with hardware counters, it must be set before the phases start.
+     */
+    static void setPerfCounters(bool enabled) {
+        perfCounters = enabled;
+    }
+
+    static bool isPerfCounters() {
+        return perfCounters;
+    }
+
+    /**
+     * counters of a thread started before the phases, e.g. a worker of the pool shared by a batch.
+     * The counters of a process phase only see the threads started after it, a phase adds these.
+     * They must stay open until the phases using them end.
+     */
+    static void addWorkerCounters(const PerfCounters *counters);
+    static void removeWorkerCounters(const PerfCounters *counters);
+
+    /**
+     * add the counts of the worker counters to values.
+     */
+    static void addWorkerEvents(uint64_t values[PerfCounters::EVENTS]);
+
+    /**
+     * write the phases, the queues, the counters and the memory of the subsystems to path as JSON.
+     */
+    static bool write(std::string path);
+
+private:
+
+    static std::atomic<uint64_t> counters[COUNTERS];
+    static std::atomic<uint64_t> memoryCurrent[MEMORIES];
+    static std::atomic<uint64_t> memoryPeak[MEMORIES];
+    static std::mutex mutex;
+    static std::vector<Phase> phases;
+    static std::vector<Queue> queues;
+    static bool perfCounters;
+    static std::vector<const PerfCounters *> workerCounters;
+
+    Metrics();
+};
+
+/**
+ * measures a phase from its construction to end(), or to its destruction.
+ * A phase of the process counts all its threads, a phase of a thread (e.g. building a CFG
+ * in a worker) only the calling thread, and its runs are accumulated.
+ */
+class MetricsPhase {
+
+public:
+
+    MetricsPhase(std::string name, bool thread = false);
+
+    ~MetricsPhase() {
+        end();
+    }
+
+    /**
+     * record the phase, only the first call records it.
+     */
+    const Metrics::Phase &end();
+
+private:
+
+    Metrics::Phase phase;
+    bool thread;
+    bool ended;
+    std::chrono::steady_clock::time_point start;
+    double startCPU;
+    long startMinorFaults;
+    long startMajorFaults;
+    long startContextSwitches;
+
+    // the counters of a process phase, a thread phase reads the counters of its thread
+    PerfCounters counters;
+    uint64_t startEvents[PerfCounters::EVENTS];
+
+    const PerfCounters *getCounters();
+
+    MetricsPhase(const MetricsPhase&);
+    MetricsPhase& operator =(const MetricsPhase&);
+};
+
+#endif
@@ -0,0 +1,95 @@
+#include "PerfCounters.h"
+
+#include <cstring>
+
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+namespace {
+
+const uint64_t configs[PerfCounters::EVENTS] = {
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES
+};
+
+const char *const names[PerfCounters::EVENTS] = {
+    "instructions",
+    "cycles",
+    "cacheMisses",
+    "branchMisses"
+};
+
+} // end of anonymous namespace
+
+PerfCounters::PerfCounters() {
+
+    for (int &fd : fds) {
+        fd = -1;
+    }
+}
+
+PerfCounters::~PerfCounters() {
+
+    close();
+}
+
+/**
+ * the counters are opened separately, inherited counters cannot be read as a group.
+ */
+bool PerfCounters::open(bool inherit) {
+
+    close();
+    for (int i = 0; i < EVENTS; i++) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[i];
+        attr.disabled = 1;
+        attr.inherit = inherit ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        fds[i] = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        if (fds[i] == -1) {
+            close();
+            return false;
+        }
+    }
+    for (int fd : fds) {
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    return true;
+}
+
+void PerfCounters::close() {
+
+    for (int &fd : fds) {
+        if (fd != -1) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+}
+
+void PerfCounters::read(uint64_t values[EVENTS]) const {
+
+    for (int i = 0; i < EVENTS; i++) {
+        // value, time enabled, time running
+        uint64_t data[3] = {0, 0, 0};
+        values[i] = 0;
+        if (fds[i] == -1 || ::read(fds[i], data, sizeof(data)) != sizeof(data)) {
+            continue;
+        }
+        values[i] = data[2] == 0 || data[2] >= data[1] ? data[0] : (uint64_t)((double)data[0] * data[1] / data[2]);
+    }
+}
+
+const char *PerfCounters::getName(Event event) {
+
+    return names[event];
+}
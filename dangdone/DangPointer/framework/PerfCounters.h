@@ -0,0 +1,49 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdint.h>
+
+/**
+ * hardware counters of perf_event_open(2) for the calling thread.
+ * With inherit, threads started after open() are counted as well, once they exit.
+ * open() fails when the kernel or the perf_event_paranoid setting do not allow them,
+ * statistics then only have the software measures of getrusage.
+ */
+class PerfCounters {
+
+public:
+
+    enum Event {
+        INSTRUCTIONS,
+        CYCLES,
+        CACHE_MISSES,
+        BRANCH_MISSES,
+        EVENTS
+    };
+
+    PerfCounters();
+    ~PerfCounters();
+
+    bool open(bool inherit);
+    void close();
+
+    bool isOpen() const {
+        return fds[0] != -1;
+    }
+
+    /**
+     * counts since open(), scaled when the kernel multiplexed the counters.
+     */
+    void read(uint64_t values[EVENTS]) const;
+
+    static const char *getName(Event event);
+
+private:
+
+    int fds[EVENTS];
+
+    PerfCounters(const PerfCounters&);
+    PerfCounters& operator =(const PerfCounters&);
+};
+
+#endif
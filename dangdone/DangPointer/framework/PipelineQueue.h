@@ -0,0 +1,96 @@
+#ifndef PIPELINE_QUEUE_H
+#define PIPELINE_QUEUE_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <algorithm>
+#include <condition_variable>
+
+#include "Metrics.h"
+
+/**
+ * a bounded queue between two stages of a pipeline, items come out in the order of their sequence.
+ * Producers may finish items out of order: the item of sequence s waits for room until s is
+ * within capacity of the next item popped, so at most capacity items are held.
+ * Several consumers may pop, each gets the next item in sequence order.
+ * The time producers wait for room and the consumers wait for the next item is measured.
+ */
+template <typename T>
+class PipelineQueue {
+
+public:
+
+    PipelineQueue(std::string name, unsigned capacity) :
+        slots(std::max(1u, capacity)), filled(std::max(1u, capacity), false), next(0), depth(0), depths(0) {
+
+        stats.name = name;
+        stats.capacity = slots.size();
+    }
+
+    void push(unsigned sequence, T item) {
+
+        std::unique_lock<std::mutex> lock(mutex);
+        if (sequence >= next + slots.size()) {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            room.wait(lock, [this, sequence] { return sequence < next + slots.size(); });
+            stats.pushStall += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        slots[sequence % slots.size()] = std::move(item);
+        filled[sequence % slots.size()] = true;
+        depth++;
+        stats.maxDepth = std::max(stats.maxDepth, depth);
+        ready.notify_all();
+    }
+
+    /**
+     * the next item in sequence order, waiting for it.
+     */
+    T pop() {
+
+        std::unique_lock<std::mutex> lock(mutex);
+        // another consumer may take the item this one waited for, the slot is read after the wait
+        if (!filled[next % slots.size()]) {
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            ready.wait(lock, [this] { return filled[next % slots.size()]; });
+            stats.popStall += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        unsigned slot = next % slots.size();
+        T item = std::move(slots[slot]);
+        filled[slot] = false;
+        depths += depth;
+        depth--;
+        next++;
+        stats.items++;
+        room.notify_all();
+        return item;
+    }
+
+    Metrics::Queue getStats() {
+
+        std::lock_guard<std::mutex> lock(mutex);
+        Metrics::Queue result = stats;
+        result.meanDepth = stats.items == 0 ? 0 : (double)depths / stats.items;
+        return result;
+    }
+
+private:
+
+    std::vector<T> slots;
+    std::vector<bool> filled;
+    unsigned next;
+    unsigned depth;
+    // sum of the depths seen by pop, for the mean depth
+    uint64_t depths;
+    Metrics::Queue stats;
+
+    std::mutex mutex;
+    std::condition_variable room;
+    std::condition_variable ready;
+
+    PipelineQueue(const PipelineQueue&);
+    PipelineQueue& operator =(const PipelineQueue&);
+};
+
+#endif
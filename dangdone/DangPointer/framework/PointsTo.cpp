@@ -0,0 +1,282 @@
+#include "PointsTo.h"
+
+#include <algorithm>
+
+#include "clang/AST/RecursiveASTVisitor.h"
+
+/**
+ * the statements of a function moving pointers around.
+ */
+class PointsToVisitor : public RecursiveASTVisitor<PointsToVisitor> {
+
+public:
+
+    PointsToVisitor(PointsTo &pointsTo, ASTFunction *F) : pointsTo(pointsTo), F(F) {}
+
+    bool VisitBinaryOperator(BinaryOperator *E) {
+        if (E->getOpcode() == BO_Assign && E->getType()->isAnyPointerType()) {
+            unsigned location = pointsTo.getLocation(E->getLHS());
+            if (location != PointsTo::NONE) {
+                pointsTo.assign(location, E->getRHS());
+            }
+        }
+        return true;
+    }
+
+    bool VisitVarDecl(VarDecl *VD) {
+        if (VD->getType()->isAnyPointerType() && VD->getInit() != nullptr && !isa<ParmVarDecl>(VD)) {
+            pointsTo.assign(pointsTo.getNode(pointsTo.getKey(VD)), VD->getInit());
+        }
+        return true;
+    }
+
+    bool VisitCallExpr(CallExpr *E) {
+        FunctionDecl *callee = E->getDirectCallee();
+        ASTFunction *calleeFunction = callee != nullptr ? pointsTo.call_graph.getFunction(callee) : nullptr;
+        if (calleeFunction == nullptr) {
+            return true;
+        }
+        unsigned size = std::min(E->getNumArgs(), calleeFunction->getParamSize());
+        for (unsigned i = 0; i < size; i++) {
+            if (E->getArg(i)->getType()->isAnyPointerType()) {
+                pointsTo.assign(pointsTo.getNode(PointsTo::getParamKey(calleeFunction, i)), E->getArg(i));
+            }
+        }
+        return true;
+    }
+
+    bool VisitReturnStmt(ReturnStmt *S) {
+        if (S->getRetValue() != nullptr && S->getRetValue()->getType()->isAnyPointerType()) {
+            pointsTo.assign(pointsTo.getNode(PointsTo::getReturnKey(F)), S->getRetValue());
+        }
+        return true;
+    }
+
+private:
+
+    PointsTo &pointsTo;
+    ASTFunction *F;
+};
+
+const unsigned PointsTo::NONE;
+
+/**
+ * analyze all functions, one AST after another, and keep the classes of the values only.
+ */
+PointsTo::PointsTo(ASTManager &manager, const ASTResource &resource, const CallGraph &call_graph) :
+    call_graph(call_graph), curFunction(nullptr), locations(0), classes(0) {
+
+    for (ASTFile *AF : resource.getASTFiles()) {
+        for (ASTFunction *F : AF->getFunctions()) {
+            if (F->isUse()) {
+                analyzeFunction(F, manager.getFunctionDecl(F));
+            }
+        }
+    }
+
+    std::unordered_map<unsigned, unsigned> classOf;
+    for (auto &content : keyNodes) {
+        unsigned pointee = pointees[nodes.find(content.second)];
+        if (pointee == NONE) {
+            continue;
+        }
+        pointee = nodes.find(pointee);
+        auto it = classOf.find(pointee);
+        if (it == classOf.end()) {
+            it = classOf.insert(std::make_pair(pointee, classOf.size())).first;
+        }
+        values[content.first] = it->second;
+    }
+    locations = keyNodes.size();
+    classes = classOf.size();
+
+    nodes.clear();
+    std::vector<unsigned>().swap(pointees);
+    std::unordered_map<uint64_t, unsigned>().swap(keyNodes);
+}
+
+uint64_t PointsTo::getGlobalKey(const std::string &name) {
+
+    return common::hashString(name, common::hashString("global"));
+}
+
+uint64_t PointsTo::getLocalKey(const ASTFunction *F, const std::string &name) {
+
+    return common::hashString(name, common::hashCombine(common::hashString("local"), F->getID()));
+}
+
+uint64_t PointsTo::getParamKey(const ASTFunction *F, unsigned index) {
+
+    return common::hashCombine(common::hashCombine(common::hashString("param"), F->getID()), index);
+}
+
+uint64_t PointsTo::getReturnKey(const ASTFunction *F) {
+
+    return common::hashCombine(common::hashString("return"), F->getID());
+}
+
+uint64_t PointsTo::getFieldKey(const std::string &name) {
+
+    return common::hashString(name, common::hashString("field"));
+}
+
+void PointsTo::analyzeFunction(ASTFunction *F, FunctionDecl *FD) {
+
+    if (FD == nullptr || !FD->hasBody()) {
+        return;
+    }
+    curFunction = F;
+    PointsToVisitor visitor(*this, F);
+    visitor.TraverseStmt(FD->getBody());
+    curFunction = nullptr;
+}
+
+uint64_t PointsTo::getKey(const VarDecl *VD) const {
+
+    if (const ParmVarDecl *PVD = dyn_cast<ParmVarDecl>(VD)) {
+        return getParamKey(curFunction, PVD->getFunctionScopeIndex());
+    }
+    if (VD->hasGlobalStorage() && !VD->isStaticLocal()) {
+        return getGlobalKey(VD->getQualifiedNameAsString());
+    }
+    return getLocalKey(curFunction, VD->getQualifiedNameAsString());
+}
+
+unsigned PointsTo::getNode(uint64_t key) {
+
+    auto it = keyNodes.find(key);
+    if (it != keyNodes.end()) {
+        return it->second;
+    }
+    unsigned node = nodes.add();
+    pointees.push_back(NONE);
+    keyNodes[key] = node;
+    return node;
+}
+
+/**
+ * the class node points to, created when it points nowhere yet.
+ */
+unsigned PointsTo::getPointee(unsigned node) {
+
+    unsigned root = nodes.find(node);
+    if (pointees[root] == NONE) {
+        unsigned pointee = nodes.add();
+        pointees.push_back(NONE);
+        pointees[root] = pointee;
+    }
+    return pointees[root];
+}
+
+/**
+ * unify the classes of a and b, and then the classes they point to.
+ */
+void PointsTo::join(unsigned a, unsigned b) {
+
+    std::vector<std::pair<unsigned, unsigned>> pending(1, std::make_pair(a, b));
+    while (!pending.empty()) {
+        unsigned rootA = nodes.find(pending.back().first);
+        unsigned rootB = nodes.find(pending.back().second);
+        pending.pop_back();
+        if (rootA == rootB) {
+            continue;
+        }
+        unsigned pointeeA = pointees[rootA];
+        unsigned pointeeB = pointees[rootB];
+        unsigned root = nodes.unite(rootA, rootB);
+        pointees[root] = pointeeA != NONE ? pointeeA : pointeeB;
+        if (pointeeA != NONE && pointeeB != NONE) {
+            pending.push_back(std::make_pair(pointeeA, pointeeB));
+        }
+    }
+}
+
+/**
+ * node of the location an lvalue designates, NONE if it is not tracked.
+ */
+unsigned PointsTo::getLocation(const Expr *E) {
+
+    E = E->IgnoreParenImpCasts();
+    if (const DeclRefExpr *DRE = dyn_cast<DeclRefExpr>(E)) {
+        if (const VarDecl *VD = dyn_cast<VarDecl>(DRE->getDecl())) {
+            return getNode(getKey(VD));
+        }
+        return NONE;
+    }
+    if (const MemberExpr *ME = dyn_cast<MemberExpr>(E)) {
+        return getNode(getFieldKey(ME->getMemberDecl()->getNameAsString()));
+    }
+    if (const UnaryOperator *UO = dyn_cast<UnaryOperator>(E)) {
+        if (UO->getOpcode() == UO_Deref) {
+            return getValue(UO->getSubExpr());
+        }
+        return NONE;
+    }
+    if (const ArraySubscriptExpr *ASE = dyn_cast<ArraySubscriptExpr>(E)) {
+        return getValue(ASE->getBase());
+    }
+    return NONE;
+}
+
+/**
+ * node of the class the value of a pointer expression points to, NONE if it is not tracked.
+ * The elements of an array are the array itself.
+ */
+unsigned PointsTo::getValue(const Expr *E) {
+
+    E = E->IgnoreParens();
+    if (const CastExpr *CE = dyn_cast<CastExpr>(E)) {
+        if (CE->getCastKind() == CK_ArrayToPointerDecay) {
+            return getLocation(CE->getSubExpr());
+        }
+        return getValue(CE->getSubExpr());
+    }
+    if (const UnaryOperator *UO = dyn_cast<UnaryOperator>(E)) {
+        if (UO->getOpcode() == UO_AddrOf) {
+            return getLocation(UO->getSubExpr());
+        }
+    }
+    if (const BinaryOperator *BO = dyn_cast<BinaryOperator>(E)) {
+        if (BO->getOpcode() == BO_Assign || BO->getOpcode() == BO_Comma) {
+            return getValue(BO->getRHS());
+        }
+        if (BO->isAdditiveOp()) {
+            return getValue(BO->getLHS()->getType()->isAnyPointerType() ? BO->getLHS() : BO->getRHS());
+        }
+        return NONE;
+    }
+    if (const ConditionalOperator *CO = dyn_cast<ConditionalOperator>(E)) {
+        unsigned trueValue = getValue(CO->getTrueExpr());
+        unsigned falseValue = getValue(CO->getFalseExpr());
+        if (trueValue == NONE || falseValue == NONE) {
+            return trueValue != NONE ? trueValue : falseValue;
+        }
+        join(trueValue, falseValue);
+        return trueValue;
+    }
+    if (const CallExpr *call = dyn_cast<CallExpr>(E)) {
+        const FunctionDecl *callee = call->getDirectCallee();
+        if (callee == nullptr) {
+            return NONE;
+        }
+        ASTFunction *calleeFunction = call_graph.getFunction(const_cast<FunctionDecl *>(callee));
+        if (calleeFunction != nullptr) {
+            return getPointee(getNode(getReturnKey(calleeFunction)));
+        }
+        // a function without body returns a new location, e.g. malloc
+        unsigned site = nodes.add();
+        pointees.push_back(NONE);
+        return site;
+    }
+
+    unsigned location = getLocation(E);
+    return location == NONE ? NONE : getPointee(location);
+}
+
+void PointsTo::assign(unsigned location, const Expr *E) {
+
+    unsigned value = getValue(E);
+    if (value != NONE) {
+        join(getPointee(location), value);
+    }
+}
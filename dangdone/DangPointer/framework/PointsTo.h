@@ -0,0 +1,91 @@
+#ifndef POINTS_TO_H
+#define POINTS_TO_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include <stdint.h>
+
+#include "ASTManager.h"
+#include "CallGraph.h"
+#include "UnionFind.h"
+
+/**
+ * whole-program unification-based (Steensgaard) points-to analysis.
+ * Each location points to at most one class of locations, an assignment unifies the classes
+ * pointed to by both sides, so the analysis is near-linear in the size of the program.
+ * Locations are variables, parameters and returns of functions, fields (by name, for all records)
+ * and calls of functions without body (one location per call site, e.g. malloc).
+ * Calls are resolved through the call graph, calls through function pointers and
+ * initializers of global variables are ignored.
+ * Locations are named by keys, which do not depend on the loaded ASTs.
+ */
+class PointsTo {
+
+public:
+
+    static const unsigned NONE = ~0u;
+
+    PointsTo(ASTManager &manager, const ASTResource &resource, const CallGraph &call_graph);
+
+    static uint64_t getGlobalKey(const std::string &name);
+    static uint64_t getLocalKey(const ASTFunction *F, const std::string &name);
+    static uint64_t getParamKey(const ASTFunction *F, unsigned index);
+    static uint64_t getReturnKey(const ASTFunction *F);
+    static uint64_t getFieldKey(const std::string &name);
+
+    /**
+     * class of the locations the pointer stored at key may point to, NONE if it points nowhere.
+     */
+    unsigned getValueClass(uint64_t key) const {
+        auto it = values.find(key);
+        return it == values.end() ? NONE : it->second;
+    }
+
+    /**
+     * whether the pointers stored at a and b may point to the same location.
+     */
+    bool mayAlias(uint64_t a, uint64_t b) const {
+        unsigned classA = getValueClass(a);
+        return classA != NONE && classA == getValueClass(b);
+    }
+
+    unsigned getLocations() const {
+        return locations;
+    }
+
+    unsigned getClasses() const {
+        return classes;
+    }
+
+private:
+
+    const CallGraph &call_graph;
+
+    // state of the analysis, dropped once the classes are known
+    UnionFind nodes;
+    std::vector<unsigned> pointees;
+    std::unordered_map<uint64_t, unsigned> keyNodes;
+    ASTFunction *curFunction;
+
+    // the result: class of the value stored at each location
+    std::unordered_map<uint64_t, unsigned> values;
+    unsigned locations;
+    unsigned classes;
+
+    void analyzeFunction(ASTFunction *F, FunctionDecl *FD);
+
+    uint64_t getKey(const VarDecl *VD) const;
+    unsigned getNode(uint64_t key);
+    unsigned getPointee(unsigned node);
+    void join(unsigned a, unsigned b);
+
+    unsigned getLocation(const Expr *E);
+    unsigned getValue(const Expr *E);
+    void assign(unsigned location, const Expr *E);
+
+    friend class PointsToVisitor;
+};
+
+#endif
@@ -0,0 +1,67 @@
+#include "Profile.h"
+#include "JSON.h"
+
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+
+namespace {
+
+// the cheapest function is at the top of the heap
+bool moreExpensive(const FunctionCost &a, const FunctionCost &b) {
+
+    return a.getCost() > b.getCost();
+}
+
+std::string getJSON(const std::string &text) {
+
+    std::string out;
+    common::appendJSON(out, text);
+    return out;
+}
+
+} // end of anonymous namespace
+
+void Profile::add(const FunctionCost &cost) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+    functions++;
+    if (top == 0) {
+        return;
+    }
+    if (costs.size() == top) {
+        if (!moreExpensive(cost, costs.front())) {
+            return;
+        }
+        std::pop_heap(costs.begin(), costs.end(), moreExpensive);
+        costs.pop_back();
+    }
+    costs.push_back(cost);
+    std::push_heap(costs.begin(), costs.end(), moreExpensive);
+}
+
+bool Profile::write(std::string path) {
+
+    std::ofstream fout(path);
+    if (!fout.is_open()) {
+        return false;
+    }
+
+    std::vector<FunctionCost> sorted = costs;
+    std::sort(sorted.begin(), sorted.end(), moreExpensive);
+    fout << std::fixed << std::setprecision(6);
+    fout << "{\n\"functions\": " << functions << ",\n\"top\": [";
+    for (unsigned i = 0; i < sorted.size(); i++) {
+        const FunctionCost &cost = sorted[i];
+        fout << (i == 0 ? "\n" : ",\n") << "{\"function\": " << getJSON(cost.name);
+        fout << ", \"cost\": " << cost.getCost() << ", \"cfgTime\": " << cost.cfgTime << ", \"visitTime\": " << cost.visitTime
+            << ", \"blocks\": " << cost.blocks << ", \"statements\": " << cost.statements
+            << ", \"varInfos\": " << cost.varInfos << ", \"funInfos\": " << cost.funInfos << ", \"reloads\": " << cost.reloads;
+        if (cost.degraded != "") {
+            fout << ", \"degraded\": " << getJSON(cost.degraded);
+        }
+        fout << "}";
+    }
+    fout << "\n]\n}\n";
+    return true;
+}
@@ -0,0 +1,62 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+
+/**
+ * cost of analyzing a function, times in seconds.
+ * reloads is the number of ASTs loaded again to analyze it.
+ */
+class FunctionCost {
+
+public:
+
+    FunctionCost() : blocks(0), statements(0), cfgTime(0), visitTime(0), varInfos(0), funInfos(0), reloads(0) {}
+
+    double getCost() const {
+        return cfgTime + visitTime;
+    }
+
+    std::string name;
+    unsigned blocks;
+    unsigned statements;
+    double cfgTime;
+    double visitTime;
+    unsigned varInfos;
+    unsigned funInfos;
+    unsigned reloads;
+    // the budget a function went over, empty if it was analyzed fully
+    std::string degraded;
+};
+
+/**
+ * the top functions of a run by cost.
+ * Only the top ones are kept, in a heap, so the profile of a large program stays small.
+ */
+class Profile {
+
+public:
+
+    Profile(unsigned top) : top(top), functions(0) {}
+
+    void add(const FunctionCost &cost);
+
+    /**
+     * write the top functions to path as JSON, most expensive first.
+     */
+    bool write(std::string path);
+
+private:
+
+    unsigned top;
+    unsigned functions;
+    std::mutex mutex;
+    std::vector<FunctionCost> costs;
+
+    Profile(const Profile&);
+    Profile& operator =(const Profile&);
+};
+
+#endif
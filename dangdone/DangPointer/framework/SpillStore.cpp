@@ -0,0 +1,74 @@
+#include "SpillStore.h"
+
+#include <cstdio>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+SpillStore::~SpillStore() {
+
+    close();
+}
+
+bool SpillStore::open(std::string path) {
+
+    close();
+    this->path = path;
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    size = 0;
+    return fd != -1;
+}
+
+bool SpillStore::append(const std::string &record, uint64_t &offset) {
+
+    offset = size;
+    size_t written = 0;
+    while (written < record.size()) {
+        ssize_t n = ::pwrite(fd, record.data() + written, record.size() - written, offset + written);
+        if (n <= 0) {
+            // the bytes written are overwritten by the next record
+            return false;
+        }
+        written += n;
+    }
+    size += written;
+    return true;
+}
+
+std::string SpillStore::read(uint64_t offset, uint64_t length) {
+
+    if (offset + length > size) {
+        return "";
+    }
+    // the whole file is mapped again, records are read at the end of a run so this is rare
+    if (offset + length > mapped) {
+        if (data != nullptr) {
+            munmap(data, mapped);
+        }
+        void *address = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (address == MAP_FAILED) {
+            data = nullptr;
+            mapped = 0;
+            return "";
+        }
+        data = (char *)address;
+        mapped = size;
+    }
+    return std::string(data + offset, length);
+}
+
+void SpillStore::close() {
+
+    if (data != nullptr) {
+        munmap(data, mapped);
+        data = nullptr;
+        mapped = 0;
+    }
+    if (fd != -1) {
+        ::close(fd);
+        fd = -1;
+        std::remove(path.c_str());
+    }
+    size = 0;
+}
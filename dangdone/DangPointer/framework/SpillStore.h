@@ -0,0 +1,53 @@
+#ifndef SPILL_STORE_H
+#define SPILL_STORE_H
+
+#include <string>
+
+#include <stdint.h>
+
+/**
+ * an append-only file for state that is cold but still needed at the end of a run.
+ * Records are appended with write(2) and read back through a memory mapping of the file,
+ * which is extended when a record past its end is read. The file is removed by close().
+ */
+class SpillStore {
+
+public:
+
+    SpillStore() : fd(-1), size(0), data(nullptr), mapped(0) {}
+    ~SpillStore();
+
+    bool open(std::string path);
+
+    bool isOpen() const {
+        return fd != -1;
+    }
+
+    /**
+     * set offset to the offset of the record in the file.
+     * false if the record could not be written whole, the store is then unchanged.
+     */
+    bool append(const std::string &record, uint64_t &offset);
+
+    std::string read(uint64_t offset, uint64_t length);
+
+    void close();
+
+    uint64_t getSize() const {
+        return size;
+    }
+
+private:
+
+    std::string path;
+    int fd;
+    uint64_t size;
+
+    char *data;
+    uint64_t mapped;
+
+    SpillStore(const SpillStore&);
+    SpillStore& operator =(const SpillStore&);
+};
+
+#endif
@@ -0,0 +1,117 @@
+#include "ThreadPool.h"
+#include "Logger.h"
+#include "Metrics.h"
+
+/**
+ * the workers have opened their counters when it returns, so a phase started after it sees them all.
+ */
+ThreadPool::ThreadPool(unsigned size, bool countWorkers) :
+    countWorkers(countWorkers), started(0), total(0), next(0), finished(0), active(0), generation(0), stop(false) {
+
+    for (unsigned i = 1; i < size; i++) {
+        threads.push_back(std::thread(&ThreadPool::work, this, i));
+    }
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return started == threads.size(); });
+}
+
+ThreadPool::~ThreadPool() {
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    start.notify_all();
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::run(unsigned n, std::function<void(unsigned, unsigned)> task) {
+
+    if (n == 0) {
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        // a thread woken late by the previous loop may still be leaving it.
+        done.wait(lock, [this] { return active == 0; });
+        this->task = task;
+        total = n;
+        next = 0;
+        finished = 0;
+        active = 1;
+        generation++;
+    }
+    start.notify_all();
+
+    loop(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    active--;
+    done.wait(lock, [this] { return finished == total && active == 0; });
+}
+
+void ThreadPool::work(unsigned worker) {
+
+    Logger::setThreadTag("worker " + std::to_string(worker));
+    PerfCounters counters;
+    if (countWorkers && counters.open(false)) {
+        Metrics::addWorkerCounters(&counters);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        started++;
+    }
+    done.notify_all();
+
+    unsigned seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            start.wait(lock, [this, seen] { return stop || generation != seen; });
+            if (stop) {
+                break;
+            }
+            seen = generation;
+            active++;
+        }
+
+        loop(worker);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            active--;
+        }
+        done.notify_all();
+    }
+    if (counters.isOpen()) {
+        Metrics::removeWorkerCounters(&counters);
+    }
+}
+
+void ThreadPool::loop(unsigned worker) {
+
+    while (true) {
+        unsigned i;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (next >= total) {
+                return;
+            }
+            i = next++;
+        }
+
+        task(worker, i);
+
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            last = (++finished == total);
+        }
+        if (last) {
+            done.notify_all();
+        }
+    }
+}
@@ -0,0 +1,60 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <functional>
+#include <condition_variable>
+
+/**
+ * a fixed set of threads running parallel loops.
+ * The calling thread takes part in each loop as worker 0.
+ * A pool made before the metrics phases (the pool of a batch) counts its workers with their
+ * own hardware counters, the counters of a phase do not inherit threads started before it.
+ */
+class ThreadPool {
+
+public:
+
+    ThreadPool(unsigned size, bool countWorkers = false);
+    ~ThreadPool();
+
+    unsigned size() const {
+        return threads.size() + 1;
+    }
+
+    /**
+     * run task(worker, i) for every i in [0, n) and wait until all are done.
+     * worker is the index of the thread running the task, in [0, size()).
+     */
+    void run(unsigned n, std::function<void(unsigned, unsigned)> task);
+
+private:
+
+    std::vector<std::thread> threads;
+
+    std::mutex mutex;
+    std::condition_variable start;
+    std::condition_variable done;
+
+    std::function<void(unsigned, unsigned)> task;
+    bool countWorkers;
+    // number of workers started, the constructor waits for all of them
+    unsigned started;
+    unsigned total;
+    unsigned next;
+    unsigned finished;
+    // number of threads inside a loop
+    unsigned active;
+    unsigned generation;
+    bool stop;
+
+    void work(unsigned worker);
+    void loop(unsigned worker);
+
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator =(const ThreadPool&);
+};
+
+#endif
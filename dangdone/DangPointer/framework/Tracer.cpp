@@ -0,0 +1,92 @@
+#include "Tracer.h"
+#include "JSON.h"
+
+#include <thread>
+
+#include <unistd.h>
+
+std::atomic<bool> Tracer::enabled(false);
+std::mutex Tracer::mutex;
+std::ofstream Tracer::fout;
+std::chrono::steady_clock::time_point Tracer::origin;
+unsigned Tracer::events = 0;
+
+namespace {
+
+/**
+ * a small id for the thread, in the order threads first write an event.
+ */
+unsigned getThreadID() {
+
+    static std::mutex mutex;
+    static unsigned next = 0;
+    thread_local unsigned id = ~0u;
+    if (id == ~0u) {
+        std::lock_guard<std::mutex> lock(mutex);
+        id = next++;
+    }
+    return id;
+}
+
+} // end of anonymous namespace
+
+/**
+ * start the trace, it must be opened before the threads writing to it are started.
+ */
+bool Tracer::open(std::string path) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+    fout.open(path, std::ios::binary | std::ios::trunc);
+    if (!fout.is_open()) {
+        return false;
+    }
+    fout << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    origin = std::chrono::steady_clock::now();
+    events = 0;
+    enabled = true;
+    return true;
+}
+
+void Tracer::close() {
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!enabled) {
+        return;
+    }
+    enabled = false;
+    fout << "\n]}\n";
+    fout.close();
+}
+
+uint64_t Tracer::now() {
+
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - origin).count();
+}
+
+void Tracer::write(const char *name, const char *category, uint64_t start, uint64_t end,
+        const char *argName, const std::string &arg) {
+
+    std::string event = "{\"name\": \"";
+    event += name;
+    event += "\", \"cat\": \"";
+    event += category;
+    event += "\", \"ph\": \"X\", \"ts\": " + std::to_string(start) + ", \"dur\": " + std::to_string(end - start);
+    event += ", \"pid\": " + std::to_string(getpid()) + ", \"tid\": " + std::to_string(getThreadID());
+    if (argName != nullptr) {
+        event += ", \"args\": {\"";
+        event += argName;
+        event += "\": ";
+        common::appendJSON(event, arg);
+        event += "}";
+    }
+    event += "}";
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!enabled) {
+        return;
+    }
+    if (events++ != 0) {
+        fout << ",\n";
+    }
+    fout << event;
+}
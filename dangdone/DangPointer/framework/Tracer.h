@@ -0,0 +1,93 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <string>
+#include <fstream>
+#include <mutex>
+#include <chrono>
+#include <atomic>
+
+#include <stdint.h>
+
+/**
+ * a timeline of the run in the Chrome trace-event format, opened with --trace=path.
+ * Spans are complete ("X") events with the thread running them, the file loads in
+ * chrome://tracing or Perfetto. When tracing is off a span only tests isEnabled().
+ */
+class Tracer {
+
+public:
+
+    static bool open(std::string path);
+    static void close();
+
+    static bool isEnabled() {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * microseconds since the trace was opened.
+     */
+    static uint64_t now();
+
+    static void write(const char *name, const char *category, uint64_t start, uint64_t end,
+            const char *argName, const std::string &arg);
+
+private:
+
+    static std::atomic<bool> enabled;
+    static std::mutex mutex;
+    static std::ofstream fout;
+    static std::chrono::steady_clock::time_point origin;
+    static unsigned events;
+
+    Tracer();
+};
+
+/**
+ * a span from its construction to the end of its scope.
+ */
+class TraceSpan {
+
+public:
+
+    TraceSpan(const char *name, const char *category) :
+        name(name), category(category), argName(nullptr), start(Tracer::isEnabled() ? Tracer::now() : 0) {}
+
+    ~TraceSpan() {
+        if (Tracer::isEnabled()) {
+            Tracer::write(name, category, start, Tracer::now(), argName, arg);
+        }
+    }
+
+    bool isActive() const {
+        return Tracer::isEnabled();
+    }
+
+    void setArg(const char *name, const std::string &value) {
+        argName = name;
+        arg = value;
+    }
+
+private:
+
+    const char *name;
+    const char *category;
+    const char *argName;
+    std::string arg;
+    uint64_t start;
+
+    TraceSpan(const TraceSpan&);
+    TraceSpan& operator =(const TraceSpan&);
+};
+
+/**
+ * a span named name in the current scope, tagged with argName = arg.
+ * arg is only evaluated when tracing is on.
+ */
+#define TRACE_SPAN(var, name, category, argName, arg) \
+    TraceSpan var(name, category); \
+    if (var.isActive()) \
+        var.setArg(argName, arg)
+
+#endif
@@ -0,0 +1,47 @@
+#include "UnionFind.h"
+
+#include <utility>
+
+unsigned UnionFind::add() {
+
+    unsigned x = parent.size();
+    parent.push_back(x);
+    rank.push_back(0);
+    link.push_back(x);
+    return x;
+}
+
+unsigned UnionFind::find(unsigned x) {
+
+    unsigned root = x;
+    while (parent[root] != root) {
+        root = parent[root];
+    }
+    // path compression
+    while (parent[x] != root) {
+        unsigned up = parent[x];
+        parent[x] = root;
+        x = up;
+    }
+    return root;
+}
+
+unsigned UnionFind::unite(unsigned a, unsigned b) {
+
+    a = find(a);
+    b = find(b);
+    if (a == b) {
+        return a;
+    }
+
+    if (rank[a] < rank[b]) {
+        std::swap(a, b);
+    }
+    parent[b] = a;
+    if (rank[a] == rank[b]) {
+        rank[a]++;
+    }
+    // splice the two rings
+    std::swap(link[a], link[b]);
+    return a;
+}
@@ -0,0 +1,51 @@
+#ifndef UNION_FIND_H
+#define UNION_FIND_H
+
+#include <vector>
+
+/**
+ * disjoint sets of elements numbered from 0, with union by rank and path compression.
+ * The elements of a set are linked in a ring, so a set can be walked without allocation.
+ */
+class UnionFind {
+
+public:
+
+    /**
+     * add an element in a set of its own, return its number.
+     */
+    unsigned add();
+
+    unsigned find(unsigned x);
+
+    /**
+     * merge the sets of a and b, return the representative of the merged set.
+     */
+    unsigned unite(unsigned a, unsigned b);
+
+    /**
+     * the element after x in the ring of its set, x itself for a set of one element.
+     */
+    unsigned next(unsigned x) const {
+        return link[x];
+    }
+
+    unsigned size() const {
+        return parent.size();
+    }
+
+    void clear() {
+        parent.clear();
+        rank.clear();
+        link.clear();
+    }
+
+private:
+
+    std::vector<unsigned> parent;
+    std::vector<unsigned char> rank;
+    std::vector<unsigned> link;
+
+};
+
+#endif
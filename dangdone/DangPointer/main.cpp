@@ -2,7 +2,8 @@
 #include <string>
 #include <iostream>
 #include <fstream>
-#include <ctime>
+#include <sstream>
+#include <algorithm>
  
 
 #include "llvm-c/Target.h"
@@ -14,86 +15,227 @@
 #include "framework/Config.h"
 #include "framework/BasicChecker.h"
 #include "framework/Logger.h"
+#include "framework/Tracer.h"
+#include "framework/Metrics.h"
+#include "framework/ASTCache.h"
+#include "framework/ThreadPool.h"
+#include "framework/CheckDriver.h"
 
 #include "dangling-pointer/DanglingPointer.h"
+#include "dangling-pointer/Daemon.h"
 using namespace clang;
 using namespace llvm;
 using namespace clang::tooling;
 
-int main(int argc, const char *argv[]) {
+//wall time of time.txt
+static std::string getTime(double seconds) {
 
-    if (argc != 4 && argc != 5) {
-        std::cout << "usage: huawei-checker astList.txt config.txt pathtoBlackWhiteList [pathToReport]" << std::endl;
-    }
-    
-    std::string pathToReport = "./";
-    if (argc == 5) {
-        pathToReport = argv[4];
-        if (pathToReport[pathToReport.size() - 1] != '\\' && pathToReport[pathToReport.size() - 1] != '/')
-            pathToReport += "/";
-    }
+    unsigned sec = unsigned(seconds);
+    return std::to_string(sec / 60) + "min" + std::to_string(sec % 60) + "sec";
+}
+
+//check the program of astList with the configuration config, the output is written to pathToReport.
+//pool is the thread pool of a batch, nullptr for a single run.
+static int run(const std::string &astList, const std::string &config, std::string pathToReport,
+    bool resume, const std::string &daemon, ThreadPool *pool) {
+
+    if (pathToReport == "")
+        pathToReport = "./";
+    if (pathToReport[pathToReport.size() - 1] != '\\' && pathToReport[pathToReport.size() - 1] != '/')
+        pathToReport += "/";
 
     ofstream process_file(pathToReport + "time.txt");
 	if(!process_file.is_open()){	
 		cerr << "output path: " + pathToReport + " does not exist\n";
         return -1;
 	}
-	clock_t startCTime , endCTime; 
-	startCTime = clock();
+	MetricsPhase total("total");
 
-    LLVMInitializeNativeTarget();
-    LLVMInitializeNativeAsmParser();
+    std::vector<std::string> ASTs = initialize(astList);
     
-    std::vector<std::string> ASTs = initialize(argv[1]);
-    
-    Config configure(argv[2]);
+    Config configure(config);
+    //a recheck would analyze every function again, the summaries of the daemon depend on the
+    //alias classes of the whole program
+    if (daemon != "" && configure.getCheckOptions().pointsTo) {
+        cerr << "daemon: --daemon cannot be used with pointsTo = true\n";
+        return -1;
+    }
     
     std::unordered_map<std::string, std::string> content;
     content["path"] = pathToReport;
     configure.add("pathToReport", content);
 
-	string blackWhiteListDir="./";
+    std::unordered_map<std::string, std::string> run;
+    run["resume"] = resume ? "true" : "false";
+    configure.add("Run", run);
+    Logger::start(configure.getLogOptions());
+
+    //hardware counters are opt-in, perf_event_open may not be allowed
+    std::unordered_map<std::string, std::string> framework = configure.getOptionBlock("Framework");
+    Metrics::setPerfCounters(framework.find("perfCounters") != framework.end() && framework["perfCounters"] == "true");
 
-	if(argc >= 4){
-		blackWhiteListDir=argv[3];
-        if (blackWhiteListDir[blackWhiteListDir.size() - 1] != '\\' && blackWhiteListDir[blackWhiteListDir.size() - 1] != '/')
-            blackWhiteListDir += "/";
-	}
-	
 	process_file<<"Starting initialize AST"<<endl;
-    clock_t start, end;
-    start = clock();
 
     ASTResource resource;
+    std::unique_ptr<TraceSpan> span(new TraceSpan("initializeAST", "ast"));
+    std::unique_ptr<MetricsPhase> phase(new MetricsPhase("initializeAST"));
     ASTManager manager(ASTs, resource, configure);
+    double initialization = phase->end().wall;
+    span.reset(new TraceSpan("buildCallGraph", "callgraph"));
+    phase.reset(new MetricsPhase("buildCallGraph"));
     CallGraph call_graph(manager, resource);
-    end = clock();
-    unsigned sec = unsigned((end-start)/CLOCKS_PER_SEC);
-    unsigned min = sec/60;
-    process_file<<"Time: "<<min<<"min"<<sec%60<<"sec"<<endl;
+    initialization += phase->end().wall;
+    span.reset();
+    process_file<<"Time: "<<getTime(initialization)<<endl;
     process_file<<"End of initialize AST\n-----------------------------------------------------------"<<endl;
 
 	auto enable = configure.getOptionBlock("CheckerEnable");
 	
-    Logger::configure(configure);
 	if(enable.find("danglingPointer")->second == "true"){		 
 		process_file<<"Starting danglingPointer check"<<endl;
-		clock_t start,end;
-		start = clock();
 
 		DanglingPtr checker(&resource, &manager, &call_graph, &configure);
-		checker.check();
+		if (daemon != "")
+			checker.setResident();
+		//the driver visits the functions for the checkers, on the pool of a batch or its own
+		CheckDriver driver(resource, manager, call_graph, configure, pool);
+		driver.addChecker(&checker);
+		double checking;
+		{
+			TraceSpan checkSpan("danglingPointer", "checker");
+			MetricsPhase checkPhase("danglingPointer");
+			driver.run();
+			checking = checkPhase.end().wall;
+		}
 
-		end = clock();
-		unsigned sec = unsigned((end-start)/CLOCKS_PER_SEC);
-		unsigned min = sec/60;
-		process_file<<"Time: "<<min<<"min"<<sec%60<<"sec"<<endl;
+		process_file<<"Time: "<<getTime(checking)<<endl;
+		const std::vector<std::string> &degraded = checker.getDegraded();
+		process_file<<"Functions over budget: "<<degraded.size()<<endl;
+		for(const std::string &fun : degraded)
+			process_file<<"\t"<<fun<<endl;
+		process_file<<"Chains deepened: "<<checker.getDeepenedChains()<<endl;
 		process_file<<"End of danglingPointer check\n-----------------------------------------------------------"<<endl;
+
+		//after the first check, the program stays in memory for the rechecks of the daemon
+		if (daemon != "") {
+			Daemon server(manager, resource, call_graph, driver, checker, configure);
+			if (!server.serve(daemon))
+				cerr << "daemon: cannot serve on " + daemon + "\n";
+		}
 	}
-	endCTime = clock();
-	sec = unsigned((endCTime-startCTime)/CLOCKS_PER_SEC);
-	min = sec/60;
-	process_file<<"-----------------------------------------------------------\nTotal time: "<<min<<"min"<<sec%60<<"sec"<<endl;
+	process_file<<"-----------------------------------------------------------\nTotal time: "<<getTime(total.end().wall)<<endl;
+	if(!Metrics::write(pathToReport + "metrics.json"))
+		cerr << "metrics: cannot write " + pathToReport + "metrics.json\n";
     return 0;
 }
 
+//a number of the Framework block, value if it is not set.
+static unsigned getFrameworkOption(Config &configure, const std::string &name, unsigned value) {
+
+    std::unordered_map<std::string, std::string> framework = configure.getOptionBlock("Framework");
+    auto got = framework.find(name);
+    if (got == framework.end() || got->second == "")
+        return value;
+    return std::stoul(got->second);
+}
+
+//run the projects of a manifest one after another in this process, a line is
+//"astList.txt config.txt pathToReport", empty lines and lines starting with # are skipped.
+//The runs share the thread pool and the AST cache, sized by the Framework block of the first config.
+static int runBatch(const std::string &manifest, bool resume) {
+
+    ifstream fin(manifest);
+    if (!fin.is_open()) {
+        cerr << "batch: cannot read " + manifest + "\n";
+        return -1;
+    }
+    std::vector<std::vector<std::string>> jobs;
+    std::string line;
+    while (std::getline(fin, line)) {
+        std::istringstream fields(line);
+        std::vector<std::string> job;
+        std::string field;
+        while (fields >> field)
+            job.push_back(field);
+        if (job.empty() || job[0][0] == '#')
+            continue;
+        if (job.size() != 3) {
+            cerr << "batch: expected astList.txt config.txt pathToReport: " + line + "\n";
+            return -1;
+        }
+        jobs.push_back(job);
+    }
+    if (jobs.empty())
+        return 0;
+
+    //threads = 0 means one thread per core, as for a single run
+    Config first(jobs[0][1]);
+    unsigned threads = getFrameworkOption(first, "threads", 1);
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    //the workers outlive the phases of every project, they count themselves for perfCounters
+    ThreadPool pool(threads, true);
+    ASTCache::open(getFrameworkOption(first, "astCache", getFrameworkOption(first, "queue_size", 0)));
+
+    int failed = 0;
+    for (unsigned i = 0; i < jobs.size(); i++) {
+        Metrics::reset();
+        {
+            TRACE_SPAN(span, "project", "batch", "config", jobs[i][1]);
+            if (run(jobs[i][0], jobs[i][1], jobs[i][2], resume, "", &pool) != 0)
+                failed++;
+        }
+        std::cout << "batch: " << jobs[i][2] << ": " << Metrics::get(Metrics::WARNINGS) << " warnings, "
+            << Metrics::get(Metrics::AST_CACHE_HITS) << " ASTs from the cache" << std::endl;
+    }
+    ASTCache::close();
+    return failed == 0 ? 0 : -1;
+}
+
+int main(int argc, const char *argv[]) {
+
+    //options start with "--", the other arguments keep their positions
+    bool resume = false;
+    std::string trace;
+    std::string daemon;
+    std::string batch;
+    std::vector<const char *> args;
+    for (int i = 0; i < argc; i++) {
+        if (std::string(argv[i]) == "--resume")
+            resume = true;
+        else if (std::string(argv[i]).compare(0, 8, "--trace=") == 0)
+            trace = std::string(argv[i]).substr(8);
+        else if (std::string(argv[i]).compare(0, 9, "--daemon=") == 0)
+            daemon = std::string(argv[i]).substr(9);
+        else if (std::string(argv[i]).compare(0, 8, "--batch=") == 0)
+            batch = std::string(argv[i]).substr(8);
+        else
+            args.push_back(argv[i]);
+    }
+    argc = args.size();
+    //argv ends with nullptr, as the argv of main
+    args.push_back(nullptr);
+    argv = args.data();
+
+    if ((batch == "" && argc != 4 && argc != 5) || (batch != "" && (argc != 1 || daemon != ""))) {
+        std::cout << "usage: huawei-checker [--resume] [--trace=trace.json] [--daemon=socket] astList.txt config.txt pathtoBlackWhiteList [pathToReport]" << std::endl;
+        std::cout << "       huawei-checker [--resume] [--trace=trace.json] --batch=manifest.txt" << std::endl;
+        return -1;
+    }
+
+	if (trace != "" && !Tracer::open(trace))
+		cerr << "trace: cannot write " + trace + "\n";
+
+    LLVMInitializeNativeTarget();
+    LLVMInitializeNativeAsmParser();
+
+    int result;
+    if (batch != "")
+        result = runBatch(batch, resume);
+    else
+        result = run(argv[1], argv[2], argc == 5 ? argv[4] : "./", resume, daemon, nullptr);
+	Tracer::close();
+	Logger::stop();
+    return result;
+}
+
@@ -0,0 +1,25 @@
+#include <string>
+#include <iostream>
+
+#include "dangling-pointer/ReportMerger.h"
+
+int main(int argc, const char *argv[]) {
+
+    if (argc < 3) {
+        std::cout << "usage: SDDangMerge pathToReport shard [shard ...]" << std::endl;
+        return -1;
+    }
+
+    //shards are output paths of SDDang, the merged output is written to pathToReport
+    ReportMerger merger;
+    for (int i = 2; i < argc; i++) {
+        if (!merger.addShard(argv[i]))
+            std::cerr << "shard: " << argv[i] << " has no report nor time.txt\n";
+    }
+    if (!merger.write(argv[1])) {
+        std::cerr << "output path: " << argv[1] << " does not exist\n";
+        return -1;
+    }
+    std::cout << "Warnings: " << merger.getRead() << " read, " << merger.getWarnings() << " after merging" << std::endl;
+    return 0;
+}
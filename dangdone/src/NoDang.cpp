@@ -38,6 +38,9 @@ bool NoDang::ifOneLevelPointer(Function *F)
 }
 bool NoDang::doInitialization(Module &M)
 {
+    //the index is mapped, the XML report is only parsed when there is no index.
+    if (warningIndex.open("MOLINT.POINTER.NULL.SET.idx"))
+        return false;
     pugi::xml_document doc;
     if (!doc.load_file("MOLINT.POINTER.NULL.SET.xml")) 
        return false;
@@ -60,12 +63,10 @@ bool NoDang::runOnFunction(Function &F)
     //guided by static warnning.
     bool ifPot = false;
     //for convenience....
-    if(potentialDP.empty()) ifPot = true;
-    for(auto str:potentialDP)
-    {
-        if(F.getName().str() == str)
-            ifPot = true;
-    }
+    if(warningIndex.isOpen())
+        ifPot = warningIndex.contains(F.getName().str());
+    else if(potentialDP.empty() || potentialDP.count(F.getName().str()))
+        ifPot = true;
     if(modifiedFun.find(&F) != modifiedFun.end() || (!ifPot && IFUSESTATIC))
         return false;
     modifiedFun[&F] = true;
@@ -17,6 +17,7 @@
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
 #include "./pugixml/pugixml.hpp"
+#include "WarningIndex.h"
 
 using namespace llvm;
 
@@ -70,6 +71,8 @@ namespace {
     SetVector<Value*> pairedGlobalPointer;
     //store static information
     SetVector<std::string> potentialDP;
+    //index of the functions with warnings written by SDDang, potentialDP is used without it.
+    WarningIndex warningIndex;
     //ifModified stores two type of infs, first is whether the alloca pointer is modified, the second is whther some ins need to be modified.
     //second means the modified instruction.
     DenseMap<Value*, Value*> ifModified;
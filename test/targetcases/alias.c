@@ -0,0 +1,48 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * aliases of a freed pointer: the variable assigned is reported for each alias not nulled.
+ * SDDang must report the line of each expect comment, with its description, see test.sh.
+ */
+
+char *g_buf;
+
+//p is an alias of q, neither is nulled.
+void aliasFree()
+{
+    char *q = malloc(16);
+    char *p;
+    p = q; /* expect: Variable:p is a dangling pointer. */ /* expect: Variable:p (alias as q) is a dangling pointer. */
+    free(q); /* expect: Variable:q is a dangling pointer. */
+}
+
+//the freed pointer is nulled, its alias is not.
+void aliasNulled()
+{
+    char *q = malloc(16);
+    char *p;
+    p = q; /* expect: Variable:p is a dangling pointer. */
+    free(q);
+    q = NULL;
+}
+
+//both are nulled.
+void aliasBothNulled()
+{
+    char *q = malloc(16);
+    char *p;
+    p = q;
+    free(q);
+    q = NULL;
+    p = NULL;
+}
+
+//p is an alias of a freed global.
+void aliasGlobal()
+{
+    char *p;
+    g_buf = malloc(16);
+    p = g_buf; /* expect: Variable:p is a dangling pointer. */ /* expect: Variable:p (alias as g_buf) is a dangling pointer. */
+    free(g_buf); /* expect: Variable:g_buf is a dangling pointer. */
+}
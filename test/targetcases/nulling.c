@@ -0,0 +1,91 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+ * nulling decided on the paths of the CFG, not on the order of the lines.
+ * SDDang must report the line of each expect comment, with its description, see test.sh.
+ */
+
+//freed on one branch, nulled on the other: p is still freed at the exit.
+void freeOrNull(int c)
+{
+    char *p = malloc(16);
+    if(c)
+        free(p); /* expect: Variable:p is a dangling pointer. */
+    else
+        p = NULL;
+}
+
+//freed and nulled on the same branch.
+void freeAndNull(int c)
+{
+    char *p = malloc(16);
+    if(c)
+    {
+        free(p);
+        p = NULL;
+    }
+}
+
+//the nulling is before the free in the file, but after it on the only path.
+void nullAfterFreeByGoto()
+{
+    char *p = malloc(16);
+    goto release;
+nullify:
+    p = NULL;
+    return;
+release:
+    free(p);
+    goto nullify;
+}
+
+//the nulling is after the free in the file, but on another path.
+void nullOnOtherPath(int c)
+{
+    char *p = malloc(16);
+    if(c)
+        goto nullify;
+    free(p); /* expect: Variable:p is a dangling pointer. */
+    return;
+nullify:
+    p = NULL;
+}
+
+//the pointer freed in the last iteration is not nulled.
+void freeInLoop(int n)
+{
+    char *p;
+    int i;
+    for(i = 1; i < n; i++)
+    {
+        p = malloc(16);
+        free(p); /* expect: Variable:p is a dangling pointer. */
+    }
+}
+
+//every iteration nulls what it frees.
+void freeAndNullInLoop(int n)
+{
+    char *p;
+    int i;
+    for(i = 1; i < n; i++)
+    {
+        p = malloc(16);
+        free(p);
+        p = NULL;
+    }
+}
+
+//nulled at the head of the next iteration, but the loop may be left right after the free.
+void nullOnNextIteration(int n)
+{
+    char *p = malloc(16);
+    while(n > 1)
+    {
+        p = NULL;
+        p = malloc(16);
+        free(p); /* expect: Variable:p is a dangling pointer. */
+        n--;
+    }
+}
@@ -1,3 +1,86 @@
 make clean
 make bcTest
 opt -load /home/fff000/Documents/nodang/llvm/build/src/libNoDangPass.so -NoDang tests.bc -o tests_tar.bc
+
+# the dangling pointer cases: SDDang must report exactly the "expect: description" comments of their lines.
+# SDDANG is the analyzer, CLANG the clang it is built with.
+SDDANG=${SDDANG:-../../dangdone/DangPointer/build/SDDang}
+CLANG=${CLANG:-clang}
+CASES="nulling.c alias.c"
+
+# "file:line: description" of the expect comments of a case
+expected()
+{
+    grep -n "expect: " $1 | while IFS= read -r line
+    do
+        echo "$line" | grep -o "expect: [^*]*" | sed "s/^expect: //; s/ *$//; s|^|$1:${line%%:*}: |"
+    done
+}
+
+# "file:line: description" of the warnings of an XML report
+reported()
+{
+    awk -F'[<>]' '$2 == "file" { n = split($3, path, "/"); file = path[n] }
+        $2 == "description" { desc = $3 }
+        $2 == "line" { print file ":" $3 ": " desc }' $1
+}
+
+# the output directory out with the ASTs of the cases and their astList.txt
+prepare()
+{
+    rm -rf $1 && mkdir -p $1
+    for c in $2
+    do
+        ast=$1/$(basename ${c%.c}).ast
+        $CLANG -emit-ast -o $ast $c || return 1
+        echo "$PWD/$ast" >> $1/astList.txt
+    done
+}
+
+failed=0
+prepare report "$CASES" && $SDDANG report/astList.txt config.txt none report/
+for c in $CASES
+do
+    expected $c
+done | sort > report/expected.txt
+reported report/MOLINT.POINTER.NULL.SET.xml | sort > report/reported.txt
+if diff report/expected.txt report/reported.txt
+then
+    echo "dangling cases: passed"
+else
+    echo "dangling cases: failed"
+    failed=1
+fi
+
+# a run killed after some wavefronts and resumed must write the report of a run that is not killed.
+# The program is a chain of calls, one wavefront per function, so the run can be killed midway.
+mkdir -p report/resume
+awk 'BEGIN { print "#include <stdlib.h>\nvoid f0()\n{\n}"
+    for (i = 1; i <= 3000; i++)
+        printf "void f%d()\n{\n    char *p = malloc(16);\n    free(p);\n    f%d();\n}\n", i, i - 1 }' > report/resume/chain.c
+sed 's/checkpointInterval = 0/checkpointInterval = 1/' config.txt > report/resume/config.txt
+prepare report/resume/full report/resume/chain.c && $SDDANG report/resume/full/astList.txt report/resume/config.txt none report/resume/full/
+prepare report/resume/killed report/resume/chain.c
+$SDDANG report/resume/killed/astList.txt report/resume/config.txt none report/resume/killed/ &
+pid=$!
+# killed once the checkpoint has a record after its header of 16 bytes
+while kill -0 $pid 2>/dev/null && [ $(stat -c %s report/resume/killed/dangling.checkpoint 2>/dev/null || echo 0) -le 16 ]
+do
+    sleep 0.01
+done
+kill -9 $pid 2>/dev/null
+wait $pid
+if [ ! -f report/resume/killed/dangling.checkpoint ]
+then
+    echo "resume: skipped, the run ended before it could be killed"
+else
+    $SDDANG --resume report/resume/killed/astList.txt report/resume/config.txt none report/resume/killed/
+    if cmp report/resume/full/MOLINT.POINTER.NULL.SET.xml report/resume/killed/MOLINT.POINTER.NULL.SET.xml
+    then
+        echo "resume: passed"
+    else
+        echo "resume: failed"
+        failed=1
+    fi
+fi
+exit $failed